@@ -0,0 +1,93 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// runs the stippler to convergence on every corpus image, with the moments
+// of every cell summed in float and in double, and reports the iterations
+// and time each took
+//
+//   bench/accumulator [stipples] [subpixels] [scalar]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "stippler.h"
+
+namespace {
+	// the default --threshold of the command line
+	const float threshold = 0.1f;
+	const unsigned int maxIterations = 500;
+
+	void converge( const char *image, unsigned int points, unsigned int subpixels, bool noSimd, AccumulatorType accumulator ) {
+		using namespace std::chrono;
+
+		StipplingParameters parameters;
+		memset( &parameters, 0, sizeof( parameters ) );
+		parameters.inputFile = const_cast<char *>( image );
+		parameters.points = points;
+		parameters.subpixels = subpixels;
+		parameters.minSubpixels = 1.0f;
+		parameters.maxSubpixels = 16.0f;
+		parameters.centroidTolerance = 0.01f;
+		parameters.sweepTiles = 1;
+		parameters.noSimd = noSimd;
+		parameters.accumulator = accumulator;
+
+		STIPPLER_HANDLE stippler = create_stippler( &parameters );
+		if ( stippler == NULL ) {
+			fprintf( stderr, "%s: %s\n", image, stippler_getLastError() );
+			exit( 1 );
+		}
+
+		steady_clock::time_point start = steady_clock::now();
+		unsigned int iterations = 0;
+		do {
+			stippler_distribute( stippler );
+			iterations++;
+		} while ( stippler_getAverageDisplacement( stippler ) > threshold && iterations < maxIterations );
+		double elapsed = duration< double >( steady_clock::now() - start ).count();
+
+		printf( "accumulator: %-22s %-6s %3u iterations %8.2f s\n", image, accumulator == ACCUMULATOR_DOUBLE ? "double" : "float", iterations, elapsed );
+		destroy_stippler( stippler );
+	}
+}
+
+int main( int argc, char *argv[] ) {
+	unsigned int points = argc > 1 ? (unsigned int)atoi( argv[1] ) : 2000;
+	unsigned int subpixels = argc > 2 ? (unsigned int)atoi( argv[2] ) : 5;
+	bool noSimd = argc > 3 && strcmp( argv[3], "scalar" ) == 0;
+
+	const char *images[] = {
+		"corpus/erinking.png", "corpus/fairyeyes.png", "corpus/gradient.png", "corpus/klaymen.png",
+		"corpus/phoenix.png", "corpus/squirrel.png", "corpus/vase.png"
+	};
+
+	stippler_lib_init();
+	for ( size_t i = 0; i < sizeof( images ) / sizeof( images[0] ); i++ ) {
+		converge( images[i], points, subpixels, noSimd, ACCUMULATOR_FLOAT );
+		converge( images[i], points, subpixels, noSimd, ACCUMULATOR_DOUBLE );
+	}
+	stippler_lib_destroy();
+	return 0;
+}
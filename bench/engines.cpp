@@ -0,0 +1,129 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// times the Fortune sweep against the Delaunay triangulation, first on
+// their own over uniform sites in a 1000x1000 box, then as the diagram
+// engine of the stippler on vase.png with prefix sum centroids. both
+// report the best of three diagrams, for 1k to 1M sites unless a single
+// count is given.
+//
+//   bench/engines [sites]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "DelaunayTriangulation.h"
+#include "VoronoiDiagramGenerator.h"
+#include "stippler.h"
+
+namespace {
+	float stipplerDiagramTime( VoronoiEngine engine, unsigned int points ) {
+		StipplingParameters parameters;
+		memset( &parameters, 0, sizeof( parameters ) );
+		parameters.inputFile = const_cast<char *>( "corpus/vase.png" );
+		parameters.points = points;
+		// at one subpixel the prefix sums put the centroid of every cell which
+		// crosses a single row exactly on that row. at 1M stipples hundreds of
+		// them then share a row, and the hashed sweep crawls along it.
+		parameters.subpixels = 5;
+		parameters.minSubpixels = 1.0f;
+		parameters.maxSubpixels = 16.0f;
+		parameters.centroidMethod = CENTROID_PREFIX_SUM;
+		parameters.engine = engine;
+		parameters.sweepTiles = 1;
+
+		STIPPLER_HANDLE stippler = create_stippler( &parameters );
+		if ( stippler == NULL ) {
+			fprintf( stderr, "%s\n", stippler_getLastError() );
+			exit( 1 );
+		}
+
+		float best = 0.0f;
+		StipplingStatistics statistics;
+		for ( int repeat = 0; repeat < 3; repeat++ ) {
+			stippler_distribute( stippler );
+			stippler_getStatistics( stippler, &statistics );
+			if ( repeat == 0 || statistics.diagramTime < best ) {
+				best = statistics.diagramTime;
+			}
+		}
+
+		destroy_stippler( stippler );
+		return best;
+	}
+
+	void compareEngines( int sites ) {
+		using namespace std::chrono;
+
+		const float size = 1000.0f;
+
+		std::mt19937 random( 1 );
+		std::uniform_real_distribution< float > uniform( 0.0f, size );
+		std::vector< float > xValues( sites ), yValues( sites );
+		for ( int i = 0; i < sites; i++ ) {
+			xValues[i] = uniform( random );
+			yValues[i] = uniform( random );
+		}
+
+		VoronoiDiagramGenerator generator;
+		DelaunayTriangulation triangulation;
+		double fortune = 0.0, delaunay = 0.0;
+		for ( int repeat = 0; repeat < 3; repeat++ ) {
+			steady_clock::time_point start = steady_clock::now();
+			generator.generateVoronoi( &xValues[0], &yValues[0], sites, 0.0f, size, 0.0f, size );
+			double elapsed = duration< double >( steady_clock::now() - start ).count();
+			if ( repeat == 0 || elapsed < fortune ) {
+				fortune = elapsed;
+			}
+
+			start = steady_clock::now();
+			triangulation.triangulate( &xValues[0], &yValues[0], sites );
+			elapsed = duration< double >( steady_clock::now() - start ).count();
+			if ( repeat == 0 || elapsed < delaunay ) {
+				delaunay = elapsed;
+			}
+		}
+
+		printf( "engines: %d uniform sites, fortune %.1f ms, delaunay %.1f ms\n", sites, fortune * 1e3, delaunay * 1e3 );
+		printf( "engines: %d stipples on vase.png, fortune %.1f ms, delaunay %.1f ms\n", sites,
+			stipplerDiagramTime( VORONOI_FORTUNE, sites ) * 1e3, stipplerDiagramTime( VORONOI_DELAUNAY, sites ) * 1e3 );
+		fflush( stdout );
+	}
+}
+
+int main( int argc, char *argv[] ) {
+	stippler_lib_init();
+	if ( argc > 1 ) {
+		compareEngines( atoi( argv[1] ) );
+	} else {
+		for ( int sites = 1000; sites <= 1000000; sites *= 10 ) {
+			compareEngines( sites );
+		}
+	}
+	stippler_lib_destroy();
+	return 0;
+}
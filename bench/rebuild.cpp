@@ -0,0 +1,103 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// runs the stippler for a fixed number of iterations at a range of rebuild
+// tolerances, and reports the time spent on the Voronoi diagrams, how many
+// of them were rebuilt locally and how far the stipples ended up from
+// where full sweeps put them
+//
+//   bench/rebuild [image] [stipples] [iterations]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "stippler.h"
+
+namespace {
+	void run( const char *image, unsigned int points, unsigned int iterations, float tolerance, std::vector<StipplePoint> &stipples ) {
+		StipplingParameters parameters;
+		memset( &parameters, 0, sizeof( parameters ) );
+		parameters.inputFile = const_cast<char *>( image );
+		parameters.points = points;
+		parameters.subpixels = 2;
+		parameters.minSubpixels = 1.0f;
+		parameters.maxSubpixels = 16.0f;
+		parameters.centroidTolerance = 0.01f;
+		parameters.sweepTiles = 1;
+		parameters.rebuildTolerance = tolerance;
+
+		STIPPLER_HANDLE stippler = create_stippler( &parameters );
+		if ( stippler == NULL ) {
+			fprintf( stderr, "%s: %s\n", image, stippler_getLastError() );
+			exit( 1 );
+		}
+
+		StipplingStatistics statistics;
+		double diagramTime = 0.0, rebuiltCells = 0.0;
+		for ( unsigned int iteration = 0; iteration < iterations; iteration++ ) {
+			stippler_distribute( stippler );
+			stippler_getStatistics( stippler, &statistics );
+			diagramTime += statistics.diagramTime;
+			rebuiltCells += statistics.rebuiltCells;
+		}
+
+		std::vector<StipplePoint> result( points );
+		stippler_getStipples( stippler, &result[0] );
+		destroy_stippler( stippler );
+
+		float maxDistance = 0.0f, meanDistance = 0.0f;
+		if ( !stipples.empty() ) {
+			for ( unsigned int i = 0; i < points; i++ ) {
+				float d = std::sqrt( ( result[i].x - stipples[i].x ) * ( result[i].x - stipples[i].x ) + ( result[i].y - stipples[i].y ) * ( result[i].y - stipples[i].y ) );
+				maxDistance = std::max( maxDistance, d );
+				meanDistance += d / points;
+			}
+		} else {
+			stipples.swap( result );
+		}
+
+		printf( "rebuild: tolerance %5.2f  diagrams %8.1f ms  local %3u of %3u  cells %6.0f per diagram  max %6.2f px  mean %6.3f px\n",
+			tolerance, diagramTime * 1000.0, statistics.localRebuilds, iterations, rebuiltCells / iterations, maxDistance, meanDistance );
+	}
+}
+
+int main( int argc, char *argv[] ) {
+	const char *image = argc > 1 ? argv[1] : "corpus/vase.png";
+	unsigned int points = argc > 2 ? (unsigned int)atoi( argv[2] ) : 20000;
+	unsigned int iterations = argc > 3 ? (unsigned int)atoi( argv[3] ) : 50;
+
+	// the full sweeps come first, as the stipples to compare with
+	const float tolerances[] = { 0.0f, 0.1f, 0.25f, 0.5f, 1.0f, 2.0f };
+	std::vector<StipplePoint> stipples;
+
+	stippler_lib_init();
+	for ( size_t i = 0; i < sizeof( tolerances ) / sizeof( tolerances[0] ); i++ ) {
+		run( image, points, iterations, tolerances[i], stipples );
+	}
+	stippler_lib_destroy();
+	return 0;
+}
@@ -0,0 +1,100 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// times the site sort of the Voronoi sweep the way the Lloyd iterations
+// use it: uniform sites in a 1000x1000 box, jittered by up to half a
+// pixel between diagrams, against qsort of the same sites
+//
+//   bench/sort [sites] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "VoronoiDiagramGenerator.h"
+
+namespace {
+	struct SortPoint {
+		float x, y;
+	};
+
+	// the order the sweep sorts its sites in, bottom to top then left to right
+	int comparePoints( const void *a, const void *b ) {
+		const SortPoint *p = (const SortPoint *)a, *q = (const SortPoint *)b;
+		if ( p->y != q->y ) return p->y < q->y ? -1 : 1;
+		if ( p->x != q->x ) return p->x < q->x ? -1 : 1;
+		return 0;
+	}
+}
+
+int main( int argc, char *argv[] ) {
+	using namespace std::chrono;
+
+	int sites = argc > 1 ? atoi( argv[1] ) : 64000;
+	int iterations = argc > 2 ? atoi( argv[2] ) : 10;
+	const float size = 1000.0f;
+
+	std::mt19937 random( 1 );
+	std::uniform_real_distribution< float > uniform( 0.0f, size ), jitter( -0.5f, 0.5f );
+	std::vector< float > xValues( sites ), yValues( sites );
+	for ( int i = 0; i < sites; i++ ) {
+		xValues[i] = uniform( random );
+		yValues[i] = uniform( random );
+	}
+
+	VoronoiDiagramGenerator generator;
+	float first = 0.0f, steady = 0.0f;
+	for ( int iteration = 0; iteration < iterations; iteration++ ) {
+		generator.generateVoronoi( &xValues[0], &yValues[0], sites, 0.0f, size, 0.0f, size );
+		if ( iteration == 0 ) {
+			first = generator.getSortTime();
+		} else {
+			steady += generator.getSortTime();
+		}
+
+		for ( int i = 0; i < sites; i++ ) {
+			xValues[i] = std::min( size, std::max( 0.0f, xValues[i] + jitter( random ) ) );
+			yValues[i] = std::min( size, std::max( 0.0f, yValues[i] + jitter( random ) ) );
+		}
+	}
+
+	std::vector< SortPoint > points( sites );
+	double reference = 0.0;
+	for ( int repeat = 0; repeat < 5; repeat++ ) {
+		for ( int i = 0; i < sites; i++ ) {
+			points[i].x = xValues[i];
+			points[i].y = yValues[i];
+		}
+
+		steady_clock::time_point start = steady_clock::now();
+		qsort( &points[0], sites, sizeof( SortPoint ), comparePoints );
+		reference += duration< double >( steady_clock::now() - start ).count();
+	}
+
+	printf( "sort: %d sites, qsort %.2f ms, first diagram %.2f ms, steady state %.2f ms\n",
+		sites, reference / 5.0 * 1e3, first * 1e3, iterations > 1 ? steady / ( iterations - 1 ) * 1e3 : 0.0 );
+	return 0;
+}
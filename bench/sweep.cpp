@@ -0,0 +1,83 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// times the Voronoi sweep with every beach line and event queue, on
+// uniform sites and on sites of which nine in ten crowd into seven
+// gaussian blobs 4 pixels wide. the best of three diagrams is reported,
+// with the memory the generator holds to build one.
+//
+//   bench/sweep [sites] [box size]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "VoronoiDiagramGenerator.h"
+
+int main( int argc, char *argv[] ) {
+	using namespace std::chrono;
+
+	int sites = argc > 1 ? atoi( argv[1] ) : 100000;
+	float size = argc > 2 ? (float)atof( argv[2] ) : 1000.0f;
+
+	const char *structureNames[4] = { "hashed+buckets", "hashed+heap", "treap+buckets", "treap+heap" };
+	for ( int clustered = 0; clustered < 2; clustered++ ) {
+		std::mt19937 random( 1 );
+		std::uniform_real_distribution< float > uniform( 0.0f, size );
+		std::normal_distribution< float > blob( 0.0f, 4.0f );
+		std::vector< float > xValues( sites ), yValues( sites );
+		for ( int i = 0; i < sites; i++ ) {
+			if ( clustered && i % 10 != 0 ) {
+				int c = i % 7;
+				xValues[i] = std::min( size, std::max( 0.0f, size * ( 0.1f + c * 0.12f ) + blob( random ) ) );
+				yValues[i] = std::min( size, std::max( 0.0f, size * ( 0.5f + ( c % 3 ) * 0.1f ) + blob( random ) ) );
+			} else {
+				xValues[i] = uniform( random );
+				yValues[i] = uniform( random );
+			}
+		}
+
+		for ( int s = 0; s < 4; s++ ) {
+			VoronoiDiagramGenerator generator;
+			generator.setStructures( s < 2 ? VoronoiDiagramGenerator::BEACHLINE_HASHED : VoronoiDiagramGenerator::BEACHLINE_TREAP,
+				s % 2 ? VoronoiDiagramGenerator::EVENTQUEUE_HEAP : VoronoiDiagramGenerator::EVENTQUEUE_BUCKETED );
+
+			double best = 0.0;
+			for ( int repeat = 0; repeat < 3; repeat++ ) {
+				steady_clock::time_point start = steady_clock::now();
+				generator.generateVoronoi( &xValues[0], &yValues[0], sites, 0.0f, size, 0.0f, size );
+				double elapsed = duration< double >( steady_clock::now() - start ).count();
+				if ( repeat == 0 || elapsed < best ) {
+					best = elapsed;
+				}
+			}
+
+			printf( "sweep: %-9s %d sites, %-14s %8.1f ms, %7.1f MB, %zu edges\n", clustered ? "clustered" : "uniform", sites,
+				structureNames[s], best * 1e3, generator.getTotalAlloc() / 1048576.0, generator.getEdges().x1.size() );
+		}
+	}
+	return 0;
+}
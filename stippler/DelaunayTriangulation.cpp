@@ -0,0 +1,503 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "DelaunayTriangulation.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "utility.h"
+
+DelaunayTriangulation::DelaunayTriangulation()
+: xValues(NULL), yValues(NULL), siteCount(0), lastTriangle(0), walkSteps(0), sortTime(0.0f) {
+}
+
+bool DelaunayTriangulation::triangulate( const float *xValues, const float *yValues, int siteCount ) {
+	this->xValues = xValues;
+	this->yValues = yValues;
+	this->siteCount = siteCount;
+
+	// a triangulation has about twice as many triangles as sites
+	triangles.clear();
+	triangles.reserve( 2 * siteCount + 4 );
+	siteTriangles.assign( siteCount, -1 );
+	pending.clear();
+	walkSteps = 0;
+
+	sortSites();
+
+	if ( !createFirstTriangle() ) {
+		return false;
+	}
+
+	for ( int i = 0; i < siteCount; i++ ) {
+		if ( siteTriangles[order[i]] < 0 && !insertSite( order[i] ) ) {
+			return false;
+		}
+	}
+
+	createDual();
+
+	return true;
+}
+
+long DelaunayTriangulation::getTotalAlloc() const {
+	return (long)( keys.capacity() * sizeof( keys[0] ) + order.capacity() * sizeof( int ) + triangles.capacity() * sizeof( Triangle ) +
+		siteTriangles.capacity() * sizeof( int ) + pending.capacity() * sizeof( int ) +
+		( offsets.capacity() + neighbours.capacity() + faces.capacity() ) * sizeof( int ) +
+		( centresX.capacity() + centresY.capacity() ) * sizeof( float ) );
+}
+
+void DelaunayTriangulation::sortSites() {
+	using std::make_pair;
+	using std::sort;
+	using std::min;
+	using std::max;
+	using std::chrono::steady_clock;
+	using std::chrono::duration;
+
+	steady_clock::time_point start = steady_clock::now();
+
+	float minX = xValues[0], minY = yValues[0], maxX = xValues[0], maxY = yValues[0];
+	for ( int i = 1; i < siteCount; i++ ) {
+		minX = min( minX, xValues[i] ); maxX = max( maxX, xValues[i] );
+		minY = min( minY, yValues[i] ); maxY = max( maxY, yValues[i] );
+	}
+
+	float scale = 65535.0f / max( max( maxX - minX, maxY - minY ), 1e-6f );
+	keys.resize( siteCount );
+
+	// every site lands in the last round with probability one half, in the
+	// one before it with one quarter and so on. the coin flips are seeded the
+	// same way every time so the triangulation does not change between runs.
+	unsigned int random = 2463534242u;
+
+	for ( int i = 0; i < siteCount; i++ ) {
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+
+		unsigned long long round = 0;
+		while ( round < 31 && ( random >> round & 1 ) ) {
+			round++;
+		}
+
+		unsigned int x = min( (unsigned int)( ( xValues[i] - minX ) * scale ), 65535u );
+		unsigned int y = min( (unsigned int)( ( yValues[i] - minY ) * scale ), 65535u );
+
+		keys[i] = make_pair( ( 31 - round ) << 32 | hilbertIndex( x, y ), i );
+	}
+
+	sort( keys.begin(), keys.end() );
+
+	order.resize( siteCount );
+	for ( int i = 0; i < siteCount; i++ ) {
+		order[i] = keys[i].second;
+	}
+
+	sortTime = duration<float>( steady_clock::now() - start ).count();
+}
+
+bool DelaunayTriangulation::createFirstTriangle() {
+	// the first three sites of the order which are not on one line
+	int a = order.empty() ? -1 : order[0], b = -1, c = -1;
+
+	for ( int i = 1; i < siteCount && b < 0; i++ ) {
+		if ( xValues[order[i]] != xValues[a] || yValues[order[i]] != yValues[a] ) {
+			b = order[i];
+		}
+	}
+
+	for ( int i = 1; i < siteCount && b >= 0 && c < 0; i++ ) {
+		if ( orientation( a, b, order[i] ) != 0.0 ) {
+			c = order[i];
+		}
+	}
+
+	if ( c < 0 ) {
+		return false;
+	}
+
+	if ( orientation( a, b, c ) < 0.0 ) {
+		std::swap( b, c );
+	}
+
+	// the triangle and the three beyond its sides, which meet at infinity
+	triangles.resize( 4 );
+	setTriangle( 0, a, b, c, 1, 2, 3 );
+	setTriangle( 1, c, b, INFINITE_SITE, 3, 2, 0 );
+	setTriangle( 2, a, c, INFINITE_SITE, 1, 3, 0 );
+	setTriangle( 3, b, a, INFINITE_SITE, 2, 1, 0 );
+
+	lastTriangle = 0;
+
+	return true;
+}
+
+bool DelaunayTriangulation::insertSite( int site ) {
+	int t = locate( site );
+
+	if ( t < 0 ) {
+		return false;
+	}
+
+	if ( findCorner( t, INFINITE_SITE ) < 0 ) {
+		const Triangle &triangle = triangles[t];
+		int zeros = 0, side = 0;
+
+		for ( int k = 0; k < 3; k++ ) {
+			int corner = triangle.sites[k];
+
+			// of two sites in the same place only the first gets a cell
+			if ( xValues[corner] == xValues[site] && yValues[corner] == yValues[site] ) {
+				if ( site < corner ) {
+					replaceSite( corner, site );
+				}
+				return true;
+			}
+
+			if ( orientation( triangle.sites[( k + 1 ) % 3], triangle.sites[( k + 2 ) % 3], site ) == 0.0 ) {
+				zeros++;
+				side = k;
+			}
+		}
+
+		if ( zeros > 1 ) {
+			return false;
+		} else if ( zeros == 1 ) {
+			splitSide( t, side, site );
+			legalize();
+			return true;
+		}
+	}
+
+	// a triangle past the hull is split the same way, which joins the site
+	// to both ends of the hull side it sees
+	splitTriangle( t, site );
+	legalize();
+
+	return true;
+}
+
+int DelaunayTriangulation::locate( int site ) {
+	int t = lastTriangle;
+
+	// walk towards the site across any side it is beyond. rounding can make
+	// the walk go around in circles, in which case every triangle is tried.
+	for ( size_t step = 0; step < triangles.size(); step++ ) {
+		const Triangle &triangle = triangles[t];
+		int ghost = findCorner( t, INFINITE_SITE );
+
+		if ( ghost >= 0 ) {
+			if ( orientation( triangle.sites[( ghost + 1 ) % 3], triangle.sites[( ghost + 2 ) % 3], site ) > 0.0 ) {
+				return t;
+			}
+
+			t = triangle.neighbours[ghost];
+			continue;
+		}
+
+		int next = -1;
+
+		for ( int e = 0; e < 3 && next < 0; e++ ) {
+			int k = ( walkSteps + e ) % 3;
+
+			if ( orientation( triangle.sites[( k + 1 ) % 3], triangle.sites[( k + 2 ) % 3], site ) < 0.0 ) {
+				next = triangle.neighbours[k];
+			}
+		}
+
+		walkSteps++;
+
+		if ( next < 0 ) {
+			return t;
+		}
+
+		t = next;
+	}
+
+	for ( size_t u = 0; u < triangles.size(); u++ ) {
+		const Triangle &triangle = triangles[u];
+		int ghost = findCorner( (int)u, INFINITE_SITE ), k = 0;
+
+		if ( ghost >= 0 ) {
+			if ( orientation( triangle.sites[( ghost + 1 ) % 3], triangle.sites[( ghost + 2 ) % 3], site ) > 0.0 ) {
+				return (int)u;
+			}
+			continue;
+		}
+
+		while ( k < 3 && orientation( triangle.sites[( k + 1 ) % 3], triangle.sites[( k + 2 ) % 3], site ) >= 0.0 ) {
+			k++;
+		}
+
+		if ( k == 3 ) {
+			return (int)u;
+		}
+	}
+
+	return -1;
+}
+
+void DelaunayTriangulation::splitTriangle( int t, int site ) {
+	Triangle triangle = triangles[t];
+	int a = triangle.sites[0], b = triangle.sites[1], c = triangle.sites[2];
+	int t1 = (int)triangles.size(), t2 = t1 + 1;
+
+	triangles.resize( triangles.size() + 2 );
+
+	setTriangle( t, site, b, c, triangle.neighbours[0], t1, t2 );
+	setTriangle( t1, site, c, a, triangle.neighbours[1], t2, t );
+	setTriangle( t2, site, a, b, triangle.neighbours[2], t, t1 );
+	replaceNeighbour( triangle.neighbours[1], t, t1 );
+	replaceNeighbour( triangle.neighbours[2], t, t2 );
+
+	pending.push_back( t );
+	pending.push_back( t1 );
+	pending.push_back( t2 );
+	lastTriangle = t;
+}
+
+void DelaunayTriangulation::splitSide( int t, int side, int site ) {
+	// the site is on side a b of triangle c a b, which it shares with
+	// triangle d b a. both are split in two.
+	Triangle triangle = triangles[t];
+	int c = triangle.sites[side], a = triangle.sites[( side + 1 ) % 3], b = triangle.sites[( side + 2 ) % 3];
+	int tA = triangle.neighbours[( side + 1 ) % 3], tB = triangle.neighbours[( side + 2 ) % 3];
+
+	int u = triangle.neighbours[side];
+	Triangle other = triangles[u];
+	int j = 0;
+	while ( other.neighbours[j] != t ) {
+		j++;
+	}
+	int d = other.sites[j];
+	int uA = other.neighbours[( j + 1 ) % 3], uB = other.neighbours[( j + 2 ) % 3];
+
+	int t1 = (int)triangles.size(), u1 = t1 + 1;
+
+	triangles.resize( triangles.size() + 2 );
+
+	setTriangle( t, site, b, c, tA, t1, u );
+	setTriangle( t1, site, c, a, tB, u1, t );
+	setTriangle( u, site, d, b, uB, t, u1 );
+	setTriangle( u1, site, a, d, uA, u, t1 );
+	replaceNeighbour( tB, t, t1 );
+	replaceNeighbour( uA, u, u1 );
+
+	pending.push_back( t );
+	pending.push_back( t1 );
+	pending.push_back( u );
+	pending.push_back( u1 );
+	lastTriangle = t;
+}
+
+void DelaunayTriangulation::legalize() {
+	// every pending triangle has the new site as its first corner, and the
+	// side opposite it is flipped if the triangle across is not Delaunay
+	while ( !pending.empty() ) {
+		int t = pending.back();
+		pending.pop_back();
+
+		Triangle triangle = triangles[t];
+		int u = triangle.neighbours[0];
+		Triangle other = triangles[u];
+		int j = 0;
+		while ( other.neighbours[j] != t ) {
+			j++;
+		}
+
+		int p = triangle.sites[0], v1 = triangle.sites[1], v2 = triangle.sites[2], q = other.sites[j];
+
+		if ( !inCircumcircle( t, q ) ) {
+			continue;
+		}
+
+		// close to degenerate the flip could turn a triangle inside out
+		if ( ( v1 != INFINITE_SITE && orientation( p, v1, q ) <= 0.0 ) ||
+			( v2 != INFINITE_SITE && orientation( p, q, v2 ) <= 0.0 ) ) {
+			continue;
+		}
+
+		int tA = triangle.neighbours[1], tB = triangle.neighbours[2];
+		int uA = other.neighbours[( j + 1 ) % 3], uB = other.neighbours[( j + 2 ) % 3];
+
+		setTriangle( t, p, v1, q, uA, u, tB );
+		setTriangle( u, p, q, v2, uB, tA, t );
+		replaceNeighbour( uA, u, t );
+		replaceNeighbour( tA, t, u );
+
+		pending.push_back( t );
+		pending.push_back( u );
+	}
+}
+
+void DelaunayTriangulation::setTriangle( int t, int s0, int s1, int s2, int n0, int n1, int n2 ) {
+	Triangle &triangle = triangles[t];
+
+	triangle.sites[0] = s0; triangle.sites[1] = s1; triangle.sites[2] = s2;
+	triangle.neighbours[0] = n0; triangle.neighbours[1] = n1; triangle.neighbours[2] = n2;
+
+	for ( int k = 0; k < 3; k++ ) {
+		if ( triangle.sites[k] != INFINITE_SITE ) {
+			siteTriangles[triangle.sites[k]] = t;
+		}
+	}
+}
+
+void DelaunayTriangulation::replaceSite( int from, int to ) {
+	int first = siteTriangles[from], t = first;
+
+	do {
+		Triangle &triangle = triangles[t];
+		int k = findCorner( t, from );
+
+		triangle.sites[k] = to;
+		t = triangle.neighbours[( k + 1 ) % 3];
+	} while ( t != first );
+
+	siteTriangles[to] = first;
+	siteTriangles[from] = -1;
+}
+
+void DelaunayTriangulation::replaceNeighbour( int t, int from, int to ) {
+	Triangle &triangle = triangles[t];
+
+	for ( int k = 0; k < 3; k++ ) {
+		if ( triangle.neighbours[k] == from ) {
+			triangle.neighbours[k] = to;
+			return;
+		}
+	}
+}
+
+int DelaunayTriangulation::findCorner( int t, int site ) const {
+	const Triangle &triangle = triangles[t];
+
+	for ( int k = 0; k < 3; k++ ) {
+		if ( triangle.sites[k] == site ) {
+			return k;
+		}
+	}
+
+	return -1;
+}
+
+double DelaunayTriangulation::orientation( int a, int b, int p ) const {
+	// the two triangles on either side of a b see it from opposite ends, and
+	// evaluating it the same way round keeps their answers consistent
+	if ( a > b ) {
+		return -orientation( b, a, p );
+	}
+
+	double aX = xValues[a], aY = yValues[a];
+
+	return ( xValues[b] - aX ) * ( yValues[p] - aY ) - ( yValues[b] - aY ) * ( xValues[p] - aX );
+}
+
+bool DelaunayTriangulation::inCircumcircle( int t, int p ) const {
+	if ( p == INFINITE_SITE ) {
+		return false;
+	}
+
+	const Triangle &triangle = triangles[t];
+	int ghost = findCorner( t, INFINITE_SITE );
+
+	if ( ghost >= 0 ) {
+		// the circle of a triangle past the hull is the half plane beyond
+		// its hull side, which takes in the inside of the side itself
+		int a = triangle.sites[( ghost + 1 ) % 3], b = triangle.sites[( ghost + 2 ) % 3];
+		double o = orientation( a, b, p );
+
+		if ( o != 0.0 ) {
+			return o > 0.0;
+		}
+
+		double dX = xValues[b] - xValues[a], dY = yValues[b] - yValues[a];
+		double along = ( xValues[p] - xValues[a] ) * dX + ( yValues[p] - yValues[a] ) * dY;
+
+		return along > 0.0 && along < dX * dX + dY * dY;
+	}
+
+	double pX = xValues[p], pY = yValues[p];
+	double aX = xValues[triangle.sites[0]] - pX, aY = yValues[triangle.sites[0]] - pY;
+	double bX = xValues[triangle.sites[1]] - pX, bY = yValues[triangle.sites[1]] - pY;
+	double cX = xValues[triangle.sites[2]] - pX, cY = yValues[triangle.sites[2]] - pY;
+
+	return ( aX * aX + aY * aY ) * ( bX * cY - cX * bY ) +
+		( bX * bX + bY * bY ) * ( cX * aY - aX * cY ) +
+		( cX * cX + cY * cY ) * ( aX * bY - bX * aY ) > 0.0;
+}
+
+void DelaunayTriangulation::createDual() {
+	centresX.resize( triangles.size() );
+	centresY.resize( triangles.size() );
+
+	for ( size_t t = 0; t < triangles.size(); t++ ) {
+		const Triangle &triangle = triangles[t];
+
+		if ( findCorner( (int)t, INFINITE_SITE ) >= 0 ) {
+			continue;
+		}
+
+		double aX = xValues[triangle.sites[0]], aY = yValues[triangle.sites[0]];
+		double bX = xValues[triangle.sites[1]] - aX, bY = yValues[triangle.sites[1]] - aY;
+		double cX = xValues[triangle.sites[2]] - aX, cY = yValues[triangle.sites[2]] - aY;
+		double b2 = bX * bX + bY * bY, c2 = cX * cX + cY * cY;
+		double d = 2.0 * ( bX * cY - bY * cX );
+
+		centresX[t] = (float)( aX + ( cY * b2 - bY * c2 ) / d );
+		centresY[t] = (float)( aY + ( bX * c2 - cX * b2 ) / d );
+	}
+
+	// go around every site, neighbour by neighbour, across the side shared
+	// with the next neighbour counter-clockwise
+	offsets.resize( siteCount + 1 );
+	neighbours.clear();
+	faces.clear();
+
+	for ( int i = 0; i < siteCount; i++ ) {
+		offsets[i] = (int)neighbours.size();
+
+		int first = siteTriangles[i], t = first;
+
+		if ( first < 0 ) {
+			continue;
+		}
+
+		do {
+			const Triangle &triangle = triangles[t];
+			int k = findCorner( t, i );
+			int next = triangle.sites[( k + 1 ) % 3];
+
+			if ( next != INFINITE_SITE ) {
+				neighbours.push_back( next );
+				faces.push_back( findCorner( t, INFINITE_SITE ) < 0 ? t : -1 );
+			}
+
+			t = triangle.neighbours[( k + 1 ) % 3];
+		} while ( t != first );
+	}
+
+	offsets[siteCount] = (int)neighbours.size();
+}
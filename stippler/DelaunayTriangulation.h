@@ -0,0 +1,108 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef DELAUNAY_TRIANGULATION_H
+#define DELAUNAY_TRIANGULATION_H
+
+#include <vector>
+#include <utility>
+
+// Delaunay triangulation of the sites built by incremental insertion, and
+// the Voronoi diagram read off it as its dual. the sites are inserted in
+// rounds of doubling size, each round in Hilbert curve order, so that every
+// point location walk starts next to where it ends.
+class DelaunayTriangulation {
+public:
+	// the point at infinity the hull edges are joined to, so that every
+	// triangle has three neighbours
+	static const int INFINITE_SITE = -1;
+
+	struct Triangle {
+		// the corners in counter-clockwise order, and the triangle across
+		// the side opposite each corner
+		int sites[3];
+		int neighbours[3];
+	};
+
+	DelaunayTriangulation();
+
+	// triangulates the sites, and returns false if they could not be, such
+	// as when all of them lie on one line
+	bool triangulate( const float *xValues, const float *yValues, int siteCount );
+
+	// the Delaunay neighbours of site i in counter-clockwise order are
+	// neighbours[offsets[i]] to neighbours[offsets[i + 1]], and faces holds
+	// the triangle between each neighbour and the next one, -1 outside the
+	// hull. a site in the same place as an earlier one has no neighbours.
+	const std::vector< int > &getOffsets() const { return offsets; }
+	const std::vector< int > &getNeighbours() const { return neighbours; }
+	const std::vector< int > &getFaces() const { return faces; }
+
+	// the circumcentre of every triangle, which are the Voronoi vertices
+	const std::vector< float > &getCentresX() const { return centresX; }
+	const std::vector< float > &getCentresY() const { return centresY; }
+
+	const std::vector< Triangle > &getTriangles() const { return triangles; }
+
+	float getSortTime() const { return sortTime; }
+	long getTotalAlloc() const;
+protected:
+	void sortSites();
+	bool createFirstTriangle();
+	bool insertSite( int site );
+	int locate( int site );
+	void splitTriangle( int t, int site );
+	void splitSide( int t, int side, int site );
+	void legalize();
+
+	void setTriangle( int t, int s0, int s1, int s2, int n0, int n1, int n2 );
+	void replaceSite( int from, int to );
+	void replaceNeighbour( int t, int from, int to );
+	int findCorner( int t, int site ) const;
+
+	double orientation( int a, int b, int p ) const;
+	bool inCircumcircle( int t, int p ) const;
+	void createDual();
+protected:
+	const float *xValues, *yValues;
+	int siteCount;
+
+	// the insertion order of the sites, sorted by round and Hilbert index
+	std::vector< std::pair< unsigned long long, int > > keys;
+	std::vector< int > order;
+	std::vector< Triangle > triangles;
+
+	// a triangle touching each site, and the triangles whose side opposite
+	// the newest site still has to be checked
+	std::vector< int > siteTriangles;
+	std::vector< int > pending;
+	int lastTriangle;
+	unsigned int walkSteps;
+
+	std::vector< int > offsets, neighbours, faces;
+	std::vector< float > centresX, centresY;
+
+	float sortTime;
+};
+
+#endif // DELAUNAY_TRIANGULATION_H
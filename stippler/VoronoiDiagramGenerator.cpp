@@ -1,1015 +1,1644 @@
-/*
-* The author of this software is Steven Fortune.  Copyright (c) 1994 by AT&T
-* Bell Laboratories.
-* Permission to use, copy, modify, and distribute this software for any
-* purpose without fee is hereby granted, provided that this entire notice
-* is included in all copies of any software which is or includes a copy
-* or modification of this software and in all copies of the supporting
-* documentation for such software.
-* THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
-* WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR AT&T MAKE ANY
-* REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING THE MERCHANTABILITY
-* OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
-*/
-
-/* 
-* This code was originally written by Stephan Fortune in C code.  I, Shane O'Sullivan, 
-* have since modified it, encapsulating it in a C++ class and, fixing memory leaks and 
-* adding accessors to the Voronoi Edges.
-* Permission to use, copy, modify, and distribute this software for any
-* purpose without fee is hereby granted, provided that this entire notice
-* is included in all copies of any software which is or includes a copy
-* or modification of this software and in all copies of the supporting
-* documentation for such software.
-* THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
-* WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR AT&T MAKE ANY
-* REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING THE MERCHANTABILITY
-* OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
-*/
-
-#include "VoronoiDiagramGenerator.h"
-
-#include <limits>
-
-VoronoiDiagramGenerator::VoronoiDiagramGenerator()
-{
-	siteidx = 0;
-	sites = 0;
-
-	allMemoryList = new FreeNodeArrayList;
-	allMemoryList->memory = 0;
-	allMemoryList->next = 0;
-	currentMemoryBlock = allMemoryList;
-	allEdges = 0;
-	iteratorEdges = 0;
-	minDistanceBetweenSites = 0;
-}
-
-VoronoiDiagramGenerator::~VoronoiDiagramGenerator()
-{
-	cleanup();
-	cleanupEdges();
-
-	if(allMemoryList != 0)
-		delete allMemoryList;
-}
-
-
-
-bool VoronoiDiagramGenerator::generateVoronoi(float *xValues, float *yValues, int numPoints, float minX, float maxX, float minY, float maxY, float minDist)
-{
-	cleanup();
-	cleanupEdges();
-	int i;
-
-	minDistanceBetweenSites = minDist;
-
-	nsites=numPoints;
-	plot = 0;
-	triangulate = 0;	
-	debug = 1;
-	sorted = 0; 
-	freeinit(&sfl, sizeof (Site));
-		
-	sites = (struct Site *) myalloc(nsites*sizeof( *sites));
-
-	if(sites == 0)
-		return false;
-
-	xmin = xValues[0];
-	ymin = yValues[0];
-	xmax = xValues[0];
-	ymax = yValues[0];
-
-	for(i = 0; i< nsites; i++)
-	{
-		sites[i].coord.x = xValues[i];
-		sites[i].coord.y = yValues[i];
-		sites[i].sitenbr = i;
-		sites[i].refcnt = 0;
-
-		if(xValues[i] < xmin)
-			xmin = xValues[i];
-		else if(xValues[i] > xmax)
-			xmax = xValues[i];
-
-		if(yValues[i] < ymin)
-			ymin = yValues[i];
-		else if(yValues[i] > ymax)
-			ymax = yValues[i];
-
-		//printf("\n%f %f\n",xValues[i],yValues[i]);
-	}
-	
-	qsort(sites, nsites, sizeof (*sites), scomp);
-	
-	siteidx = 0;
-	geominit();
-	float temp = 0;
-	if(minX > maxX)
-	{
-		temp = minX;
-		minX = maxX;
-		maxX = temp;
-	}
-	if(minY > maxY)
-	{
-		temp = minY;
-		minY = maxY;
-		maxY = temp;
-	}
-	borderMinX = minX;
-	borderMinY = minY;
-	borderMaxX = maxX;
-	borderMaxY = maxY;
-	
-	siteidx = 0;
-	voronoi(triangulate);
-
-	return true;
-}
-
-bool VoronoiDiagramGenerator::ELinitialize()
-{
-	int i;
-	freeinit(&hfl, sizeof **ELhash);
-	ELhashsize = 2 * sqrt_nsites;
-	ELhash = (struct Halfedge **) myalloc ( sizeof *ELhash * ELhashsize);
-
-	if(ELhash == 0)
-		return false;
-
-	for(i=0; i<ELhashsize; i +=1) ELhash[i] = (struct Halfedge *)NULL;
-	ELleftend = HEcreate( (struct Edge *)NULL, 0);
-	ELrightend = HEcreate( (struct Edge *)NULL, 0);
-	ELleftend -> ELleft = (struct Halfedge *)NULL;
-	ELleftend -> ELright = ELrightend;
-	ELrightend -> ELleft = ELleftend;
-	ELrightend -> ELright = (struct Halfedge *)NULL;
-	ELhash[0] = ELleftend;
-	ELhash[ELhashsize-1] = ELrightend;
-
-	return true;
-}
-
-
-struct VoronoiDiagramGenerator::Halfedge* VoronoiDiagramGenerator::HEcreate(struct VoronoiDiagramGenerator::Edge *e,int pm)
-{
-	struct Halfedge *answer;
-	answer = (struct Halfedge *) getfree(&hfl);
-	answer -> ELedge = e;
-	answer -> ELpm = pm;
-	answer -> PQnext = (struct Halfedge *) NULL;
-	answer -> vertex = (struct Site *) NULL;
-	answer -> ELrefcnt = 0;
-	return(answer);
-}
-
-
-void VoronoiDiagramGenerator::ELinsert(struct	VoronoiDiagramGenerator::Halfedge *lb, struct VoronoiDiagramGenerator::Halfedge *newHe)
-{
-	newHe -> ELleft = lb;
-	newHe -> ELright = lb -> ELright;
-	(lb -> ELright) -> ELleft = newHe;
-	lb -> ELright = newHe;
-}
-
-/* Get entry from hash table, pruning any deleted nodes */
-struct VoronoiDiagramGenerator::Halfedge * VoronoiDiagramGenerator::ELgethash(int b)
-{
-	struct Halfedge *he;
-	
-	if(b<0 || b>=ELhashsize) 
-		return((struct Halfedge *) NULL);
-	he = ELhash[b]; 
-	if (he == (struct Halfedge *) NULL || he->ELedge != (struct Edge *) DELETED ) 
-		return (he);
-	
-	/* Hash table points to deleted half edge.  Patch as necessary. */
-	ELhash[b] = (struct Halfedge *) NULL;
-	if ((he -> ELrefcnt -= 1) == 0) 
-		makefree((Freenode*)he, &hfl);
-	return ((struct Halfedge *) NULL);
-}	
-
-struct VoronoiDiagramGenerator::Halfedge * VoronoiDiagramGenerator::ELleftbnd(struct Point *p)
-{
-	int i, bucket;
-	struct Halfedge *he;
-	
-	/* Use hash table to get close to desired halfedge */
-	bucket = (int)((p->x - xmin)/deltax * ELhashsize);	//use the hash function to find the place in the hash map that this HalfEdge should be
-
-	if(bucket<0) bucket =0;					//make sure that the bucket position in within the range of the hash array
-	if(bucket>=ELhashsize) bucket = ELhashsize - 1;
-
-	he = ELgethash(bucket);
-	if(he == (struct Halfedge *) NULL)			//if the HE isn't found, search backwards and forwards in the hash map for the first non-null entry
-	{   
-		for(i=1; 1 ; i += 1)
-		{	
-			if ((he=ELgethash(bucket-i)) != (struct Halfedge *) NULL) 
-				break;
-			if ((he=ELgethash(bucket+i)) != (struct Halfedge *) NULL) 
-				break;
-		};
-		totalsearch += i;
-	};
-	ntry += 1;
-	/* Now search linear list of halfedges for the correct one */
-	if (he==ELleftend  || (he != ELrightend && right_of(he,p)))
-	{
-		do 
-		{
-			he = he -> ELright;
-		} while (he!=ELrightend && right_of(he,p));	//keep going right on the list until either the end is reached, or you find the 1st edge which the point
-		he = he -> ELleft;				//isn't to the right of
-	}
-	else 							//if the point is to the left of the HalfEdge, then search left for the HE just to the left of the point
-		do 
-		{
-			he = he -> ELleft;
-		} while (he!=ELleftend && !right_of(he,p));
-		
-	/* Update hash table and reference counts */
-	if(bucket > 0 && bucket <ELhashsize-1)
-	{	
-		if(ELhash[bucket] != (struct Halfedge *) NULL) 
-		{
-			ELhash[bucket] -> ELrefcnt -= 1;
-		}
-		ELhash[bucket] = he;
-		ELhash[bucket] -> ELrefcnt += 1;
-	};
-	return (he);
-}
-
-
-/* This delete routine can't reclaim node, since pointers from hash
-table may be present.   */
-void VoronoiDiagramGenerator::ELdelete(struct VoronoiDiagramGenerator::Halfedge *he)
-{
-	(he -> ELleft) -> ELright = he -> ELright;
-	(he -> ELright) -> ELleft = he -> ELleft;
-	he -> ELedge = (struct Edge *)DELETED;
-}
-
-
-struct VoronoiDiagramGenerator::Halfedge * VoronoiDiagramGenerator::ELright(struct VoronoiDiagramGenerator::Halfedge *he)
-{
-	return (he -> ELright);
-}
-
-struct VoronoiDiagramGenerator::Halfedge * VoronoiDiagramGenerator::ELleft(struct VoronoiDiagramGenerator::Halfedge *he)
-{
-	return (he -> ELleft);
-}
-
-
-struct VoronoiDiagramGenerator::Site * VoronoiDiagramGenerator::leftreg(struct VoronoiDiagramGenerator::Halfedge *he)
-{
-	if(he -> ELedge == (struct VoronoiDiagramGenerator::Edge *)NULL) 
-		return(bottomsite);
-	return( he -> ELpm == le ? 
-		he -> ELedge -> reg[le] : he -> ELedge -> reg[re]);
-}
-
-struct VoronoiDiagramGenerator::Site * VoronoiDiagramGenerator::rightreg(struct VoronoiDiagramGenerator::Halfedge *he)
-{
-	if(he -> ELedge == (struct VoronoiDiagramGenerator::Edge *)NULL) //if this halfedge has no edge, return the bottom site (whatever that is)
-		return(bottomsite);
-
-	//if the ELpm field is zero, return the site 0 that this edge bisects, otherwise return site number 1
-	return( he -> ELpm == le ? he -> ELedge -> reg[re] : he -> ELedge -> reg[le]);
-}
-
-void VoronoiDiagramGenerator::geominit()
-{	
-	float sn;
-
-	freeinit(&efl, sizeof(Edge));
-	nvertices = 0;
-	nedges = 0;
-	sn = (float)nsites+4;
-	sqrt_nsites = (int)sqrt(sn);
-	deltay = ymax - ymin;
-	deltax = xmax - xmin;
-}
-
-
-struct VoronoiDiagramGenerator::Edge * VoronoiDiagramGenerator::bisect(struct VoronoiDiagramGenerator::Site *s1,struct	VoronoiDiagramGenerator::Site *s2)
-{
-	float dx,dy,adx,ady;
-	struct Edge *newedge;	
-
-	newedge = (struct Edge *) getfree(&efl);
-	
-	newedge -> reg[0] = s1; //store the sites that this edge is bisecting
-	newedge -> reg[1] = s2;
-	ref(s1); 
-	ref(s2);
-	newedge -> ep[0] = (struct Site *) NULL; //to begin with, there are no endpoints on the bisector - it goes to infinity
-	newedge -> ep[1] = (struct Site *) NULL;
-	
-	dx = s2->coord.x - s1->coord.x;			//get the difference in x dist between the sites
-	dy = s2->coord.y - s1->coord.y;
-	adx = dx>0 ? dx : -dx;					//make sure that the difference in positive
-	ady = dy>0 ? dy : -dy;
-	newedge -> c = (float)(s1->coord.x * dx + s1->coord.y * dy + (dx*dx + dy*dy)*0.5);//get the slope of the line
-
-	if (adx>ady)
-	{	
-		newedge -> a = 1.0; newedge -> b = dy/dx; newedge -> c /= dx;//set formula of line, with x fixed to 1
-	}
-	else
-	{	
-		newedge -> b = 1.0; newedge -> a = dx/dy; newedge -> c /= dy;//set formula of line, with y fixed to 1
-	};
-	
-	newedge -> edgenbr = nedges;
-
-	//printf("\nbisect(%d) ((%f,%f) and (%f,%f)",nedges,s1->coord.x,s1->coord.y,s2->coord.x,s2->coord.y);
-	
-	nedges += 1;
-	return(newedge);
-}
-
-//create a new site where the HalfEdges el1 and el2 intersect - note that the Point in the argument list is not used, don't know why it's there
-struct VoronoiDiagramGenerator::Site * VoronoiDiagramGenerator::intersect(struct VoronoiDiagramGenerator::Halfedge *el1, struct VoronoiDiagramGenerator::Halfedge *el2, struct VoronoiDiagramGenerator::Point *p)
-{
-	struct	Edge *e1,*e2, *e;
-	struct  Halfedge *el;
-	float d, xint, yint;
-	int right_of_site;
-	struct Site *v;
-	
-	e1 = el1 -> ELedge;
-	e2 = el2 -> ELedge;
-	if(e1 == (struct Edge*)NULL || e2 == (struct Edge*)NULL) 
-		return ((struct Site *) NULL);
-
-	//if the two edges bisect the same parent, return null
-	if (e1->reg[1] == e2->reg[1]) 
-		return ((struct Site *) NULL);
-	
-	d = e1->a * e2->b - e1->b * e2->a;
-	if (-1.0e-10<d && d<1.0e-10) 
-		return ((struct Site *) NULL);
-	
-	xint = (e1->c*e2->b - e2->c*e1->b)/d;
-	yint = (e2->c*e1->a - e1->c*e2->a)/d;
-	
-	if( (e1->reg[1]->coord.y < e2->reg[1]->coord.y) ||
-		(e1->reg[1]->coord.y == e2->reg[1]->coord.y &&
-		e1->reg[1]->coord.x < e2->reg[1]->coord.x) )
-	{	
-		el = el1; 
-		e = e1;
-	}
-	else
-	{	
-		el = el2; 
-		e = e2;
-	};
-	
-	right_of_site = xint >= e -> reg[1] -> coord.x;
-	if ((right_of_site && el -> ELpm == le) || (!right_of_site && el -> ELpm == re)) 
-		return ((struct Site *) NULL);
-	
-	//create a new site at the point of intersection - this is a new vector event waiting to happen
-	v = (struct Site *) getfree(&sfl);
-	v -> refcnt = 0;
-	v -> coord.x = xint;
-	v -> coord.y = yint;
-	return(v);
-}
-
-/* returns 1 if p is to right of halfedge e */
-int VoronoiDiagramGenerator::right_of(struct VoronoiDiagramGenerator::Halfedge *el,struct VoronoiDiagramGenerator::Point *p)
-{
-	struct Edge *e;
-	struct Site *topsite;
-	int right_of_site, above, fast;
-	float dxp, dyp, dxs, t1, t2, t3, yl;
-	
-	e = el -> ELedge;
-	topsite = e -> reg[1];
-	right_of_site = p -> x > topsite -> coord.x;
-	if(right_of_site && el -> ELpm == le) return(1);
-	if(!right_of_site && el -> ELpm == re) return (0);
-	
-	if (e->a == 1.0)
-	{	dyp = p->y - topsite->coord.y;
-	dxp = p->x - topsite->coord.x;
-	fast = 0;
-	if ((!right_of_site & (e->b<0.0)) | (right_of_site & (e->b>=0.0)) )
-	{	above = dyp>= e->b*dxp;	
-	fast = above;
-	}
-	else 
-	{	above = p->x + p->y*e->b > e-> c;
-	if(e->b<0.0) above = !above;
-	if (!above) fast = 1;
-	};
-	if (!fast)
-	{	dxs = topsite->coord.x - (e->reg[0])->coord.x;
-	above = e->b * (dxp*dxp - dyp*dyp) <
-		dxs*dyp*(1.0+2.0*dxp/dxs + e->b*e->b);
-	if(e->b<0.0) above = !above;
-	};
-	}
-	else  /*e->b==1.0 */
-	{	yl = e->c - e->a*p->x;
-	t1 = p->y - yl;
-	t2 = p->x - topsite->coord.x;
-	t3 = yl - topsite->coord.y;
-	above = t1*t1 > t2*t2 + t3*t3;
-	};
-	return (el->ELpm==le ? above : !above);
-}
-
-
-void VoronoiDiagramGenerator::endpoint(struct VoronoiDiagramGenerator::Edge *e,int lr,struct VoronoiDiagramGenerator::Site * s)
-{
-	e -> ep[lr] = s;
-	ref(s);
-	if(e -> ep[re-lr]== (struct Site *) NULL) 
-		return;
-
-	clip_line(e);
-
-	deref(e->reg[le]);
-	deref(e->reg[re]);
-	makefree((Freenode*)e, &efl);
-}
-
-
-float VoronoiDiagramGenerator::dist(struct VoronoiDiagramGenerator::Site *s,struct VoronoiDiagramGenerator::Site *t)
-{
-	float dx,dy;
-	dx = s->coord.x - t->coord.x;
-	dy = s->coord.y - t->coord.y;
-	return (float)(sqrt(dx*dx + dy*dy));
-}
-
-
-void VoronoiDiagramGenerator::makevertex(struct VoronoiDiagramGenerator::Site *v)
-{
-	v -> sitenbr = nvertices;
-	nvertices += 1;
-	out_vertex(v);
-}
-
-
-void VoronoiDiagramGenerator::deref(struct VoronoiDiagramGenerator::Site *v)
-{
-	v -> refcnt -= 1;
-	if (v -> refcnt == 0 ) 
-		makefree((Freenode*)v, &sfl);
-}
-
-void VoronoiDiagramGenerator::ref(struct VoronoiDiagramGenerator::Site *v)
-{
-	v -> refcnt += 1;
-}
-
-//push the HalfEdge into the ordered linked list of vertices
-void VoronoiDiagramGenerator::PQinsert(struct VoronoiDiagramGenerator::Halfedge *he,struct VoronoiDiagramGenerator::Site * v, float offset)
-{
-	struct Halfedge *last, *next;
-	
-	he -> vertex = v;
-	ref(v);
-	he -> ystar = (float)(v -> coord.y + offset);
-	last = &PQhash[PQbucket(he)];
-	while ((next = last -> PQnext) != (struct Halfedge *) NULL &&
-		(he -> ystar  > next -> ystar  ||
-		(he -> ystar == next -> ystar && v -> coord.x > next->vertex->coord.x)))
-	{	
-		last = next;
-	};
-	he -> PQnext = last -> PQnext; 
-	last -> PQnext = he;
-	PQcount += 1;
-}
-
-//remove the HalfEdge from the list of vertices 
-void VoronoiDiagramGenerator::PQdelete(struct VoronoiDiagramGenerator::Halfedge *he)
-{
-	struct Halfedge *last;
-	
-	if(he -> vertex != (struct Site *) NULL)
-	{	
-		last = &PQhash[PQbucket(he)];
-		while (last -> PQnext != he) 
-			last = last -> PQnext;
-
-		last -> PQnext = he -> PQnext;
-		PQcount -= 1;
-		deref(he -> vertex);
-		he -> vertex = (struct Site *) NULL;
-	};
-}
-
-int VoronoiDiagramGenerator::PQbucket(struct VoronoiDiagramGenerator::Halfedge *he)
-{
-	int bucket;
-	
-	bucket = (int)((he->ystar - ymin)/deltay * PQhashsize);
-	if (bucket<0) bucket = 0;
-	if (bucket>=PQhashsize) bucket = PQhashsize-1 ;
-	if (bucket < PQmin) PQmin = bucket;
-	return(bucket);
-}
-
-
-
-int VoronoiDiagramGenerator::PQempty()
-{
-	return(PQcount==0);
-}
-
-
-struct VoronoiDiagramGenerator::Point VoronoiDiagramGenerator::PQ_min()
-{
-	struct Point answer;
-	
-	while(PQhash[PQmin].PQnext == (struct Halfedge *)NULL) {PQmin += 1;};
-	answer.x = PQhash[PQmin].PQnext -> vertex -> coord.x;
-	answer.y = PQhash[PQmin].PQnext -> ystar;
-	return (answer);
-}
-
-struct VoronoiDiagramGenerator::Halfedge * VoronoiDiagramGenerator::PQextractmin()
-{
-	struct Halfedge *curr;
-	
-	curr = PQhash[PQmin].PQnext;
-	PQhash[PQmin].PQnext = curr -> PQnext;
-	PQcount -= 1;
-	return(curr);
-}
-
-
-bool VoronoiDiagramGenerator::PQinitialize()
-{
-	int i; 
-	
-	PQcount = 0;
-	PQmin = 0;
-	PQhashsize = 4 * sqrt_nsites;
-	PQhash = (struct Halfedge *) myalloc(PQhashsize * sizeof *PQhash);
-
-	if(PQhash == 0)
-		return false;
-
-	for(i=0; i<PQhashsize; i+=1) PQhash[i].PQnext = (struct Halfedge *)NULL;
-
-	return true;
-}
-
-
-void VoronoiDiagramGenerator::freeinit(struct VoronoiDiagramGenerator::Freelist *fl,int size)
-{
-	fl -> head = (struct Freenode *) NULL;
-	fl -> nodesize = size;
-}
-
-char * VoronoiDiagramGenerator::getfree(struct VoronoiDiagramGenerator::Freelist *fl)
-{
-	int i; 
-	struct Freenode *t;
-
-	if(fl->head == (struct Freenode *) NULL)
-	{	
-		t =  (struct Freenode *) myalloc(sqrt_nsites * fl->nodesize);
-
-		if(t == 0)
-			return 0;
-		
-		currentMemoryBlock->next = new FreeNodeArrayList;
-		currentMemoryBlock = currentMemoryBlock->next;
-		currentMemoryBlock->memory = t;
-		currentMemoryBlock->next = 0;
-
-		for(i=0; i<sqrt_nsites; i+=1) 	
-			makefree((struct Freenode *)((char *)t+i*fl->nodesize), fl);		
-	};
-	t = fl -> head;
-	fl -> head = (fl -> head) -> nextfree;
-	return((char *)t);
-}
-
-
-
-void VoronoiDiagramGenerator::makefree(struct VoronoiDiagramGenerator::Freenode *curr,struct VoronoiDiagramGenerator::Freelist *fl)
-{
-	curr -> nextfree = fl -> head;
-	fl -> head = curr;
-}
-
-void VoronoiDiagramGenerator::cleanup()
-{
-	if(sites != 0)
-	{
-		free(sites);
-		sites = 0;
-	}
-
-	FreeNodeArrayList* current=0, *prev = 0;
-
-	current = prev = allMemoryList;
-
-	while(current->next != 0)
-	{
-		prev = current;
-		current = current->next;
-		free(prev->memory);
-		delete prev;
-		prev = 0;
-	}
-
-	if(current != 0 && current->memory != 0)
-	{
-		free(current->memory);
-		delete current;
-	}
-
-	allMemoryList = new FreeNodeArrayList;
-	allMemoryList->next = 0;
-	allMemoryList->memory = 0;
-	currentMemoryBlock = allMemoryList;
-}
-
-void VoronoiDiagramGenerator::cleanupEdges()
-{
-	GraphEdge* geCurrent = 0, *gePrev = 0;
-	geCurrent = gePrev = allEdges;
-
-	while(geCurrent != 0 && geCurrent->next != 0)
-	{
-		gePrev = geCurrent;
-		geCurrent = geCurrent->next;
-		delete gePrev;
-	}
-
-	allEdges = 0;
-
-}
-
-void VoronoiDiagramGenerator::pushGraphEdge(float x1, float y1, float x2, float y2,float s1x, float s1y, float s2x, float s2y)
-{
-	GraphEdge* newEdge = new GraphEdge;
-	newEdge->next = allEdges;
-	allEdges = newEdge;
-	newEdge->x1 = x1;
-	newEdge->y1 = y1;
-	newEdge->x2 = x2;
-	newEdge->y2 = y2;
-	newEdge->s1x = s1x;
-	newEdge->s1y = s1y;
-	newEdge->s2x = s2x;
-	newEdge->s2y = s2y;
-}
-
-
-char * VoronoiDiagramGenerator::myalloc(unsigned n)
-{
-	char *t=0;	
-	t=(char*)malloc(n);
-	total_alloc += n;
-	return(t);
-}
-
-
-/* for those who don't have Cherry's plot */
-/* #include <plot.h> */
-void VoronoiDiagramGenerator::openpl(){}
-void VoronoiDiagramGenerator::line(float x1, float y1, float x2, float y2, float s1x, float s1y, float s2x, float s2y )
-{	
-	pushGraphEdge(x1,y1,x2,y2, s1x, s1y, s2x, s2y);
-
-}
-void VoronoiDiagramGenerator::circle(float x, float y, float radius){}
-void VoronoiDiagramGenerator::range(float minX, float minY, float maxX, float maxY){}
-
-
-
-void VoronoiDiagramGenerator::out_bisector(struct VoronoiDiagramGenerator::Edge *e)
-{
-	
-
-}
-
-
-void VoronoiDiagramGenerator::out_ep(struct VoronoiDiagramGenerator::Edge *e)
-{
-	
-	
-}
-
-void VoronoiDiagramGenerator::out_vertex(struct VoronoiDiagramGenerator::Site *v)
-{
-	
-}
-
-
-void VoronoiDiagramGenerator::out_site(struct VoronoiDiagramGenerator::Site *s)
-{
-	if(!triangulate && plot && !debug)
-		circle (s->coord.x, s->coord.y, cradius);
-	
-}
-
-
-void VoronoiDiagramGenerator::out_triple(struct VoronoiDiagramGenerator::Site *s1, struct VoronoiDiagramGenerator::Site *s2,struct VoronoiDiagramGenerator::Site * s3)
-{
-	
-}
-
-
-
-void VoronoiDiagramGenerator::plotinit()
-{
-	float dx,dy,d;
-	
-	dy = ymax - ymin;
-	dx = xmax - xmin;
-	d = (float)(( dx > dy ? dx : dy) * 1.1);
-	pxmin = (float)(xmin - (d-dx)/2.0);
-	pxmax = (float)(xmax + (d-dx)/2.0);
-	pymin = (float)(ymin - (d-dy)/2.0);
-	pymax = (float)(ymax + (d-dy)/2.0);
-	cradius = (float)((pxmax - pxmin)/350.0);
-	openpl();
-	range(pxmin, pymin, pxmax, pymax);
-}
-
-
-void VoronoiDiagramGenerator::clip_line(struct VoronoiDiagramGenerator::Edge *e)
-{
-	struct Site *s1, *s2;
-	float x1=0,x2=0,y1=0,y2=0;
-	float s1x, s2x, s1y, s2y;
-
-	s1x = x1 = e->reg[0]->coord.x;
-	s2x = x2 = e->reg[1]->coord.x;
-	s1y = y1 = e->reg[0]->coord.y;
-	s2y = y2 = e->reg[1]->coord.y;
-
-
-	//if the distance between the two points this line was created from is less than 
-	//the square root of 2, then ignore it
-	if(sqrt(((x2 - x1) * (x2 - x1)) + ((y2 - y1) * (y2 - y1))) < minDistanceBetweenSites)
-//	if ( abs(x2-x1) + abs(y2-y1) < minDistanceBetweenSites )
-	{
-		return;
-	}
-	pxmin = borderMinX;
-	pxmax = borderMaxX;
-	pymin = borderMinY;
-	pymax = borderMaxY;
-
-	if(e -> a == 1.0 && e ->b >= 0.0)
-	{	
-		s1 = e -> ep[1];
-		s2 = e -> ep[0];
-	}
-	else 
-	{
-		s1 = e -> ep[0];
-		s2 = e -> ep[1];
-	};
-	
-	if(e -> a == 1.0)
-	{
-		y1 = pymin;
-		if (s1!=(struct Site *)NULL && s1->coord.y > pymin)
-		{
-			y1 = s1->coord.y;
-		}
-		if(y1>pymax) 
-		{
-		//	printf("\nClipped (1) y1 = %f to %f",y1,pymax);
-			y1 = pymax;
-			//return;
-		}
-		x1 = e -> c - e -> b * y1;
-		y2 = pymax;
-		if (s2!=(struct Site *)NULL && s2->coord.y < pymax) 
-			y2 = s2->coord.y;
-
-		if(y2<pymin) 
-		{
-			//printf("\nClipped (2) y2 = %f to %f",y2,pymin);
-			y2 = pymin;
-			//return;
-		}
-		x2 = (e->c) - (e->b) * y2;
-		if (((x1> pxmax) & (x2>pxmax)) | ((x1<pxmin)&(x2<pxmin))) 
-		{
-			//printf("\nClipLine jumping out(3), x1 = %f, pxmin = %f, pxmax = %f",x1,pxmin,pxmax);
-			return;
-		}
-		if(x1> pxmax)
-		{	x1 = pxmax; y1 = (e -> c - x1)/e -> b;};
-		if(x1<pxmin)
-		{	x1 = pxmin; y1 = (e -> c - x1)/e -> b;};
-		if(x2>pxmax)
-		{	x2 = pxmax; y2 = (e -> c - x2)/e -> b;};
-		if(x2<pxmin)
-		{	x2 = pxmin; y2 = (e -> c - x2)/e -> b;};
-	}
-	else
-	{
-		x1 = pxmin;
-		if (s1!=(struct Site *)NULL && s1->coord.x > pxmin) 
-			x1 = s1->coord.x;
-		if(x1>pxmax) 
-		{
-			//printf("\nClipped (3) x1 = %f to %f",x1,pxmin);
-			//return;
-			x1 = pxmax;
-		}
-		y1 = e -> c - e -> a * x1;
-		x2 = pxmax;
-		if (s2!=(struct Site *)NULL && s2->coord.x < pxmax) 
-			x2 = s2->coord.x;
-		if(x2<pxmin) 
-		{
-			//printf("\nClipped (4) x2 = %f to %f",x2,pxmin);
-			//return;
-			x2 = pxmin;
-		}
-		y2 = e -> c - e -> a * x2;
-		if (((y1> pymax) & (y2>pymax)) | ((y1<pymin)&(y2<pymin))) 
-		{
-			//printf("\nClipLine jumping out(6), y1 = %f, pymin = %f, pymax = %f",y2,pymin,pymax);
-			return;
-		}
-		if(y1> pymax)
-		{	y1 = pymax; x1 = (e -> c - y1)/e -> a;};
-		if(y1<pymin)
-		{	y1 = pymin; x1 = (e -> c - y1)/e -> a;};
-		if(y2>pymax)
-		{	y2 = pymax; x2 = (e -> c - y2)/e -> a;};
-		if(y2<pymin)
-		{	y2 = pymin; x2 = (e -> c - y2)/e -> a;};
-	};
-	
-	//printf("\nPushing line (%f,%f,%f,%f)",x1,y1,x2,y2);
-	line(x1,y1,x2,y2, s1x, s1y, s2x, s2y );
-}
-
-
-/* implicit parameters: nsites, sqrt_nsites, xmin, xmax, ymin, ymax,
-deltax, deltay (can all be estimates).
-Performance suffers if they are wrong; better to make nsites,
-deltax, and deltay too big than too small.  (?) */
-
-bool VoronoiDiagramGenerator::voronoi(int triangulate)
-{
-	struct Site *newsite, *bot, *top, *temp, *p;
-	struct Site *v;
-	struct Point newintstar;
-	int pm;
-	struct Halfedge *lbnd, *rbnd, *llbnd, *rrbnd, *bisector;
-	struct Edge *e;
-	
-	PQinitialize();
-	bottomsite = nextone();
-	out_site(bottomsite);
-	bool retval = ELinitialize();
-
-	if(!retval)
-		return false;
-	
-	newsite = nextone();
-	while(1)
-	{
-
-		if(!PQempty()) 
-			newintstar = PQ_min();
-		
-		//if the lowest site has a smaller y value than the lowest vector intersection, process the site
-		//otherwise process the vector intersection		
-
-		if (newsite != (struct Site *)NULL 	&& (PQempty() || newsite -> coord.y < newintstar.y
-			|| (newsite->coord.y == newintstar.y && newsite->coord.x < newintstar.x)))
-		{/* new site is smallest - this is a site event*/
-			out_site(newsite);						//output the site
-			lbnd = ELleftbnd(&(newsite->coord));				//get the first HalfEdge to the LEFT of the new site
-			rbnd = ELright(lbnd);						//get the first HalfEdge to the RIGHT of the new site
-			bot = rightreg(lbnd);						//if this halfedge has no edge, , bot = bottom site (whatever that is)
-			e = bisect(bot, newsite);					//create a new edge that bisects 
-			bisector = HEcreate(e, le);					//create a new HalfEdge, setting its ELpm field to 0			
-			ELinsert(lbnd, bisector);					//insert this new bisector edge between the left and right vectors in a linked list	
-
-			if ((p = intersect(lbnd, bisector)) != (struct Site *) NULL) 	//if the new bisector intersects with the left edge, remove the left edge's vertex, and put in the new one
-			{	
-				PQdelete(lbnd);
-				PQinsert(lbnd, p, dist(p,newsite));
-			};
-			lbnd = bisector;						
-			bisector = HEcreate(e, re);					//create a new HalfEdge, setting its ELpm field to 1
-			ELinsert(lbnd, bisector);					//insert the new HE to the right of the original bisector earlier in the IF stmt
-
-			if ((p = intersect(bisector, rbnd)) != (struct Site *) NULL)	//if this new bisector intersects with the
-			{	
-				PQinsert(bisector, p, dist(p,newsite));			//push the HE into the ordered linked list of vertices
-			};
-			newsite = nextone();	
-		}
-		else if (!PQempty()) /* intersection is smallest - this is a vector event */			
-		{	
-			lbnd = PQextractmin();						//pop the HalfEdge with the lowest vector off the ordered list of vectors				
-			llbnd = ELleft(lbnd);						//get the HalfEdge to the left of the above HE
-			rbnd = ELright(lbnd);						//get the HalfEdge to the right of the above HE
-			rrbnd = ELright(rbnd);						//get the HalfEdge to the right of the HE to the right of the lowest HE 
-			bot = leftreg(lbnd);						//get the Site to the left of the left HE which it bisects
-			top = rightreg(rbnd);						//get the Site to the right of the right HE which it bisects
-
-			out_triple(bot, top, rightreg(lbnd));		//output the triple of sites, stating that a circle goes through them
-
-			v = lbnd->vertex;						//get the vertex that caused this event
-			makevertex(v);							//set the vertex number - couldn't do this earlier since we didn't know when it would be processed
-			endpoint(lbnd->ELedge,lbnd->ELpm,v);	//set the endpoint of the left HalfEdge to be this vector
-			endpoint(rbnd->ELedge,rbnd->ELpm,v);	//set the endpoint of the right HalfEdge to be this vector
-			ELdelete(lbnd);							//mark the lowest HE for deletion - can't delete yet because there might be pointers to it in Hash Map	
-			PQdelete(rbnd);							//remove all vertex events to do with the  right HE
-			ELdelete(rbnd);							//mark the right HE for deletion - can't delete yet because there might be pointers to it in Hash Map	
-			pm = le;								//set the pm variable to zero
-			
-			if (bot->coord.y > top->coord.y)		//if the site to the left of the event is higher than the Site
-			{										//to the right of it, then swap them and set the 'pm' variable to 1
-				temp = bot; 
-				bot = top; 
-				top = temp; 
-				pm = re;
-			}
-			e = bisect(bot, top);					//create an Edge (or line) that is between the two Sites. This creates
-													//the formula of the line, and assigns a line number to it
-			bisector = HEcreate(e, pm);				//create a HE from the Edge 'e', and make it point to that edge with its ELedge field
-			ELinsert(llbnd, bisector);				//insert the new bisector to the right of the left HE
-			endpoint(e, re-pm, v);					//set one endpoint to the new edge to be the vector point 'v'.
-													//If the site to the left of this bisector is higher than the right
-													//Site, then this endpoint is put in position 0; otherwise in pos 1
-			deref(v);								//delete the vector 'v'
-
-			//if left HE and the new bisector don't intersect, then delete the left HE, and reinsert it 
-			if((p = intersect(llbnd, bisector)) != (struct Site *) NULL)
-			{	
-				PQdelete(llbnd);
-				PQinsert(llbnd, p, dist(p,bot));
-			};
-
-			//if right HE and the new bisector don't intersect, then reinsert it 
-			if ((p = intersect(bisector, rrbnd)) != (struct Site *) NULL)
-			{	
-				PQinsert(bisector, p, dist(p,bot));
-			};
-		}
-		else break;
-	};
-
-	
-
-
-	for(lbnd=ELright(ELleftend); lbnd != ELrightend; lbnd=ELright(lbnd))
-	{	
-		e = lbnd -> ELedge;
-
-		clip_line(e);
-	};
-
-	cleanup();
-
-	return true;
-	
-}
-
-
-int scomp(const void *p1,const void *p2)
-{
-	struct VoronoiDiagramGenerator::Point *s1 = (VoronoiDiagramGenerator::Point*)p1, *s2=(VoronoiDiagramGenerator::Point*)p2;
-	if(s1 -> y < s2 -> y) return(-1);
-	if(s1 -> y > s2 -> y) return(1);
-	if(s1 -> x < s2 -> x) return(-1);
-	if(s1 -> x > s2 -> x) return(1);
-	return(0);
-}
-
-/* return a single in-storage site */
-struct VoronoiDiagramGenerator::Site * VoronoiDiagramGenerator::nextone()
-{
-	struct VoronoiDiagramGenerator::Site *s;
-	if(siteidx < nsites)
-	{	
-		s = &sites[siteidx];
-		siteidx += 1;
-		return(s);
-	}
-	else	
-		return( (struct Site *)NULL);
-}
-
+/*
+* The author of this software is Steven Fortune.  Copyright (c) 1994 by AT&T
+* Bell Laboratories.
+* Permission to use, copy, modify, and distribute this software for any
+* purpose without fee is hereby granted, provided that this entire notice
+* is included in all copies of any software which is or includes a copy
+* or modification of this software and in all copies of the supporting
+* documentation for such software.
+* THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
+* WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR AT&T MAKE ANY
+* REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING THE MERCHANTABILITY
+* OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
+*/
+
+/* 
+* This code was originally written by Stephan Fortune in C code.  I, Shane O'Sullivan, 
+* have since modified it, encapsulating it in a C++ class and, fixing memory leaks and 
+* adding accessors to the Voronoi Edges.
+* Permission to use, copy, modify, and distribute this software for any
+* purpose without fee is hereby granted, provided that this entire notice
+* is included in all copies of any software which is or includes a copy
+* or modification of this software and in all copies of the supporting
+* documentation for such software.
+* THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
+* WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR AT&T MAKE ANY
+* REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING THE MERCHANTABILITY
+* OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
+*/
+
+#include "VoronoiDiagramGenerator.h"
+
+#include <limits>
+#include <chrono>
+#include <algorithm>
+
+VoronoiDiagramGenerator::VoronoiDiagramGenerator()
+{
+	siteidx = 0;
+	poolAlloc = 0;
+
+	allMemoryList = new FreeNodeArrayList;
+	allMemoryList->memory = 0;
+	allMemoryList->next = 0;
+	currentMemoryBlock = allMemoryList;
+	iteratorEdges = 0;
+	minDistanceBetweenSites = 0;
+
+	arena = 0;
+	arenaSize = 0;
+	arenaUsed = 0;
+	total_alloc = 0;
+	sortTime = 0;
+
+	closedCells = false;
+	cellCallback = 0;
+	cellContext = 0;
+	beachLine = BEACHLINE_HASHED;
+	eventQueue = EVENTQUEUE_BUCKETED;
+	ELroot = NIL;
+	ELseed = 2463534242u;
+}
+
+VoronoiDiagramGenerator::~VoronoiDiagramGenerator()
+{
+	cleanup();
+	cleanupEdges();
+
+	if(allMemoryList != 0)
+		delete allMemoryList;
+
+	free(arena);
+}
+
+
+
+bool VoronoiDiagramGenerator::generateVoronoi(float *xValues, float *yValues, int numPoints, float minX, float maxX, float minY, float maxY, float minDist)
+{
+	cleanup();
+	cleanupEdges();
+	resetArena();
+	int i;
+
+	minDistanceBetweenSites = minDist;
+
+	nsites=numPoints;
+	plot = 0;
+	triangulate = 0;	
+	debug = 1;
+	sorted = 0; 
+	freeinit(&sfl);
+	sites.resize(nsites);
+	sitePoints.resize(nsites);
+
+	if(cellCallback)
+	{
+		arcCounts.assign(nsites, 0);
+		cellFirstEdge.assign(nsites, NIL);
+		cellLastEdge.assign(nsites, NIL);
+	}
+
+	xmin = xValues[0];
+	ymin = yValues[0];
+	xmax = xValues[0];
+	ymax = yValues[0];
+
+	// lay the sites out in the order the last diagram sorted them into
+	bool nearlySorted = (int)sortOrder.size() == nsites;
+
+	for(i = 0; i< nsites; i++)
+	{
+		int j = nearlySorted ? sortOrder[i] : i;
+
+		sites[i].coord.x = xValues[j];
+		sites[i].coord.y = yValues[j];
+		sites[i].sitenbr = j;
+		sites[i].refcnt = 0;
+		sitePoints[j] = sites[i].coord;
+
+		if(xValues[j] < xmin)
+			xmin = xValues[j];
+		else if(xValues[j] > xmax)
+			xmax = xValues[j];
+
+		if(yValues[j] < ymin)
+			ymin = yValues[j];
+		else if(yValues[j] > ymax)
+			ymax = yValues[j];
+
+		//printf("\n%f %f\n",xValues[i],yValues[i]);
+	}
+	
+	std::chrono::steady_clock::time_point sortStart = std::chrono::steady_clock::now();
+	sortSites(nearlySorted);
+	sortTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - sortStart).count();
+	
+	siteidx = 0;
+	geominit();
+	float temp = 0;
+	if(minX > maxX)
+	{
+		temp = minX;
+		minX = maxX;
+		maxX = temp;
+	}
+	if(minY > maxY)
+	{
+		temp = minY;
+		minY = maxY;
+		maxY = temp;
+	}
+	borderMinX = minX;
+	borderMinY = minY;
+	borderMaxX = maxX;
+	borderMaxY = maxY;
+	
+	siteidx = 0;
+	bool retval = voronoi(triangulate);
+
+	// the pools are counted at their largest, which is where they end up
+	poolAlloc = (long)(sites.size() * sizeof(Site) + edges.size() * sizeof(Edge) +
+		halfedges.size() * sizeof(Halfedge) + ELtreap.size() * sizeof(TreapNode));
+
+	if(!retval)
+		return false;
+
+	if(closedCells)
+		createCells();
+
+	return true;
+}
+
+/* distance along the bounding box from its (minX, minY) corner, going
+the positive way round */
+float VoronoiDiagramGenerator::borderPosition(float x, float y)
+{
+	float w = borderMaxX - borderMinX, h = borderMaxY - borderMinY;
+	float sides[4] = { y - borderMinY, borderMaxX - x, borderMaxY - y, x - borderMinX };
+	int side = 0;
+
+	for(int i = 1; i < 4; i++)
+		if(sides[i] < sides[side])
+			side = i;
+
+	switch(side)
+	{
+	case 0: return x - borderMinX;
+	case 1: return w + y - borderMinY;
+	case 2: return w + h + borderMaxX - x;
+	default: return 2 * w + h + borderMaxY - y;
+	}
+}
+
+bool VoronoiDiagramGenerator::onBorder(float x, float y, float tolerance)
+{
+	return x - borderMinX < tolerance || borderMaxX - x < tolerance ||
+		y - borderMinY < tolerance || borderMaxY - y < tolerance;
+}
+
+void VoronoiDiagramGenerator::createCells()
+{
+	int i, j, k;
+	int nedges = (int)allEdges.x1.size();
+	float w = borderMaxX - borderMinX, h = borderMaxY - borderMinY;
+	float cornerX[4] = { borderMinX, borderMaxX, borderMaxX, borderMinX };
+	float cornerY[4] = { borderMinY, borderMinY, borderMaxY, borderMaxY };
+	float cornerPosition[4] = { 0, w, w + h, 2 * w + h };
+	float epsilon = std::numeric_limits<float>::epsilon();
+
+	// every edge works out its own copy of a shared vertex, so neighbouring
+	// sides only meet up to rounding
+	float tolerance = (w + h) * 1e-5f;
+
+	// the edges of every site, leaving out the ones that collapsed to a point
+	cellEdgeOffsets.assign(nsites + 1, 0);
+	for(i = 0; i < nedges; i++)
+	{
+		if(fabs(allEdges.x1[i] - allEdges.x2[i]) < epsilon && fabs(allEdges.y1[i] - allEdges.y2[i]) < epsilon)
+			continue;
+
+		cellEdgeOffsets[allEdges.site1[i] + 1]++;
+		cellEdgeOffsets[allEdges.site2[i] + 1]++;
+	}
+	for(i = 0; i < nsites; i++)
+		cellEdgeOffsets[i + 1] += cellEdgeOffsets[i];
+
+	cellEdgeList.resize(cellEdgeOffsets[nsites]);
+	cellEdgeFill.assign(cellEdgeOffsets.begin(), cellEdgeOffsets.end() - 1);
+	for(i = 0; i < nedges; i++)
+	{
+		if(fabs(allEdges.x1[i] - allEdges.x2[i]) < epsilon && fabs(allEdges.y1[i] - allEdges.y2[i]) < epsilon)
+			continue;
+
+		cellEdgeList[cellEdgeFill[allEdges.site1[i]]++] = i;
+		cellEdgeList[cellEdgeFill[allEdges.site2[i]]++] = i;
+	}
+
+	allCells.offsets.resize(nsites + 1);
+	allCells.x.clear();
+	allCells.y.clear();
+	allCells.neighbour.clear();
+
+	for(i = 0; i < nsites; i++)
+	{
+		struct Point s = sitePoints[i];
+		allCells.offsets[i] = (int)allCells.x.size();
+
+		// a lone site owns the whole box, a site without edges otherwise
+		// shares its place with another one and gets no cell
+		if(cellEdgeOffsets[i] == cellEdgeOffsets[i + 1])
+		{
+			if(nsites == 1)
+			{
+				for(k = 0; k < 4; k++)
+				{
+					allCells.x.push_back(cornerX[k]);
+					allCells.y.push_back(cornerY[k]);
+					allCells.neighbour.push_back(-1);
+				}
+			}
+			continue;
+		}
+
+		// turn every edge so that the site is on its left, then put them in
+		// order of the angle of their middle around the site. the ends are no
+		// good for this since a short side starts right where the last ends.
+		cellSides.clear();
+		for(j = cellEdgeOffsets[i]; j < cellEdgeOffsets[i + 1]; j++)
+		{
+			int e = cellEdgeList[j];
+			CellSide side = { allEdges.x1[e], allEdges.y1[e], allEdges.x2[e], allEdges.y2[e], 0,
+				allEdges.site1[e] == i ? allEdges.site2[e] : allEdges.site1[e] };
+
+			if((side.x2 - side.x1) * (s.y - side.y1) - (side.y2 - side.y1) * (s.x - side.x1) < 0)
+			{
+				std::swap(side.x1, side.x2);
+				std::swap(side.y1, side.y2);
+			}
+			side.angle = atan2((side.y1 + side.y2) / 2 - s.y, (side.x1 + side.x2) / 2 - s.x);
+
+			for(k = (int)cellSides.size(); k > 0 && cellSides[k - 1].angle > side.angle; k--);
+			cellSides.insert(cellSides.begin() + k, side);
+		}
+
+		// chain the sides, running along the box wherever one side ends
+		// somewhere other than where the next one starts
+		for(j = 0; j < (int)cellSides.size(); j++)
+		{
+			CellSide &side = cellSides[j], &next = cellSides[(j + 1) % cellSides.size()];
+
+			allCells.x.push_back(side.x1);
+			allCells.y.push_back(side.y1);
+			allCells.neighbour.push_back(side.neighbour);
+
+			if(fabs(side.x2 - next.x1) < tolerance && fabs(side.y2 - next.y1) < tolerance)
+				continue;
+
+			allCells.x.push_back(side.x2);
+			allCells.y.push_back(side.y2);
+			allCells.neighbour.push_back(-1);
+
+			// sites lined up exactly can leave a gap inside the box too, which
+			// is simply bridged
+			if(!onBorder(side.x2, side.y2, tolerance) || !onBorder(next.x1, next.y1, tolerance))
+				continue;
+
+			float from = borderPosition(side.x2, side.y2), to = borderPosition(next.x1, next.y1);
+			if(to <= from)
+				to += 2 * (w + h);
+
+			for(k = 1; k < 8; k++)
+			{
+				float corner = cornerPosition[k % 4] + (k >= 4 ? 2 * (w + h) : 0);
+				if(corner > from && corner < to)
+				{
+					allCells.x.push_back(cornerX[k % 4]);
+					allCells.y.push_back(cornerY[k % 4]);
+					allCells.neighbour.push_back(-1);
+				}
+			}
+		}
+	}
+
+	allCells.offsets[nsites] = (int)allCells.x.size();
+}
+
+void VoronoiDiagramGenerator::sortSites(bool nearlySorted)
+{
+	// sites barely move from one diagram to the next, so the order of the
+	// last diagram is very nearly right and insertion sort finishes it off in
+	// close to linear time. if it turns out to be far off, radix sort instead.
+	if(!nearlySorted || !insertionSortSites(4 * (long)nsites))
+		radixSortSites();
+
+	sortOrder.resize(nsites);
+	for(int i = 0; i < nsites; i++)
+		sortOrder[i] = sites[i].sitenbr;
+}
+
+bool VoronoiDiagramGenerator::insertionSortSites(long limit)
+{
+	long moves = 0;
+
+	for(int i = 1; i < nsites; i++)
+	{
+		struct Site s = sites[i];
+		int j = i;
+
+		while(j > 0 && (sites[j-1].coord.y > s.coord.y || 
+			(sites[j-1].coord.y == s.coord.y && sites[j-1].coord.x > s.coord.x)))
+		{
+			sites[j] = sites[j-1];
+			j--;
+
+			if(++moves > limit)
+			{
+				sites[j] = s;
+				return false;
+			}
+		}
+
+		sites[j] = s;
+	}
+
+	return true;
+}
+
+void VoronoiDiagramGenerator::radixSortSites()
+{
+	int i, pass;
+
+	// sort on y, then x, by flipping the bits of each float so that they
+	// order the same way as unsigned integers
+	radixKeys.resize(nsites);
+	radixBuffer.resize(nsites);
+
+	for(i = 0; i < nsites; i++)
+	{
+		unsigned int x, y;
+		memcpy(&x, &sites[i].coord.x, sizeof(x));
+		memcpy(&y, &sites[i].coord.y, sizeof(y));
+		x ^= (x >> 31) ? 0xffffffffu : 0x80000000u;
+		y ^= (y >> 31) ? 0xffffffffu : 0x80000000u;
+
+		radixKeys[i].key = ((unsigned long long)y << 32) | x;
+		radixKeys[i].index = i;
+	}
+
+	for(pass = 0; pass < 8; pass++)
+	{
+		int count[257] = { 0 };
+		int shift = pass * 8;
+
+		for(i = 0; i < nsites; i++)
+			count[((radixKeys[i].key >> shift) & 0xff) + 1]++;
+
+		// every key has the same digit, so this pass would not move anything
+		if(count[((radixKeys[0].key >> shift) & 0xff) + 1] == nsites)
+			continue;
+
+		for(i = 0; i < 256; i++)
+			count[i + 1] += count[i];
+
+		for(i = 0; i < nsites; i++)
+			radixBuffer[count[(radixKeys[i].key >> shift) & 0xff]++] = radixKeys[i];
+
+		radixKeys.swap(radixBuffer);
+	}
+
+	siteBuffer.assign(sites.begin(), sites.begin() + nsites);
+	for(i = 0; i < nsites; i++)
+		sites[i] = siteBuffer[radixKeys[i].index];
+}
+
+/* pools hand out the entries on their free list first, and only grow once
+it runs dry. the entries are only ever looked up by index, so the pool can
+move as it grows. */
+template<class T> int VoronoiDiagramGenerator::getfree(std::vector<T> &pool, struct Freelist *fl, int T::*next)
+{
+	int t;
+
+	if(fl->head == NIL)
+	{
+		pool.push_back(T());
+		return((int)pool.size() - 1);
+	}
+
+	t = fl -> head;
+	fl -> head = pool[t].*next;
+	return(t);
+}
+
+template<class T> void VoronoiDiagramGenerator::makefree(std::vector<T> &pool, struct Freelist *fl, int T::*next, int curr)
+{
+	pool[curr].*next = fl -> head;
+	fl -> head = curr;
+}
+
+void VoronoiDiagramGenerator::freeinit(struct VoronoiDiagramGenerator::Freelist *fl)
+{
+	fl -> head = NIL;
+}
+
+bool VoronoiDiagramGenerator::ELinitialize()
+{
+	int i;
+	freeinit(&hfl);
+	halfedges.clear();
+	ELtreap.clear();
+	ELleftend = HEcreate(NIL, 0);
+	ELrightend = HEcreate(NIL, 0);
+	halfedges[ELleftend].ELleft = NIL;
+	halfedges[ELleftend].ELright = ELrightend;
+	halfedges[ELrightend].ELleft = ELleftend;
+	halfedges[ELrightend].ELright = NIL;
+
+	// the ends of the beach line stay out of the treap
+	ELroot = NIL;
+	if(beachLine == BEACHLINE_TREAP)
+		return true;
+
+	ELhashsize = 2 * sqrt_nsites;
+	ELhash = (int *) myalloc ( sizeof *ELhash * ELhashsize);
+
+	if(ELhash == 0)
+		return false;
+
+	for(i=0; i<ELhashsize; i +=1) ELhash[i] = NIL;
+	ELhash[0] = ELleftend;
+	ELhash[ELhashsize-1] = ELrightend;
+
+	return true;
+}
+
+
+int VoronoiDiagramGenerator::HEcreate(int e,int pm)
+{
+	int answer = getfree(halfedges, &hfl, &Halfedge::PQnext);
+	struct Halfedge &he = halfedges[answer];
+	he.ELedge = e;
+	he.ELpm = pm;
+	he.PQnext = NIL;
+	he.vertex = NIL;
+	he.ELrefcnt = 0;
+
+	if(beachLine == BEACHLINE_TREAP)
+	{
+		if((int)ELtreap.size() <= answer)
+			ELtreap.resize(answer + 1);
+		ELtreap[answer].parent = NIL;
+		ELtreap[answer].child[0] = ELtreap[answer].child[1] = NIL;
+	}
+	return(answer);
+}
+
+
+void VoronoiDiagramGenerator::ELinsert(int lb, int newHe)
+{
+	halfedges[newHe].ELleft = lb;
+	halfedges[newHe].ELright = halfedges[lb].ELright;
+	halfedges[halfedges[lb].ELright].ELleft = newHe;
+	halfedges[lb].ELright = newHe;
+
+	if(beachLine == BEACHLINE_TREAP)
+		ELtreapinsert(lb, newHe);
+}
+
+/* Get entry from hash table, pruning any deleted nodes */
+int VoronoiDiagramGenerator::ELgethash(int b)
+{
+	int he;
+	
+	if(b<0 || b>=ELhashsize) 
+		return(NIL);
+	he = ELhash[b]; 
+	if (he == NIL || halfedges[he].ELedge != DELETED ) 
+		return (he);
+	
+	/* Hash table points to deleted half edge.  Patch as necessary. */
+	ELhash[b] = NIL;
+	if ((halfedges[he].ELrefcnt -= 1) == 0) 
+		makefree(halfedges, &hfl, &Halfedge::PQnext, he);
+	return (NIL);
+}	
+
+int VoronoiDiagramGenerator::ELleftbnd(struct Point *p)
+{
+	int i, bucket;
+	int he;
+
+	if(beachLine == BEACHLINE_TREAP)
+		return ELtreapleftbnd(p);
+	
+	/* Use hash table to get close to desired halfedge */
+	bucket = (int)((p->x - xmin)/deltax * ELhashsize);	//use the hash function to find the place in the hash map that this HalfEdge should be
+
+	if(bucket<0) bucket =0;					//make sure that the bucket position in within the range of the hash array
+	if(bucket>=ELhashsize) bucket = ELhashsize - 1;
+
+	he = ELgethash(bucket);
+	if(he == NIL)			//if the HE isn't found, search backwards and forwards in the hash map for the first non-null entry
+	{   
+		for(i=1; 1 ; i += 1)
+		{	
+			if ((he=ELgethash(bucket-i)) != NIL) 
+				break;
+			if ((he=ELgethash(bucket+i)) != NIL) 
+				break;
+		};
+		totalsearch += i;
+	};
+	ntry += 1;
+	/* Now search linear list of halfedges for the correct one */
+	if (he==ELleftend  || (he != ELrightend && right_of(he,p)))
+	{
+		do 
+		{
+			he = halfedges[he].ELright;
+		} while (he!=ELrightend && right_of(he,p));	//keep going right on the list until either the end is reached, or you find the 1st edge which the point
+		he = halfedges[he].ELleft;				//isn't to the right of
+	}
+	else 							//if the point is to the left of the HalfEdge, then search left for the HE just to the left of the point
+		do 
+		{
+			he = halfedges[he].ELleft;
+		} while (he!=ELleftend && !right_of(he,p));
+		
+	/* Update hash table and reference counts */
+	if(bucket > 0 && bucket <ELhashsize-1)
+	{	
+		if(ELhash[bucket] != NIL) 
+		{
+			halfedges[ELhash[bucket]].ELrefcnt -= 1;
+		}
+		ELhash[bucket] = he;
+		halfedges[he].ELrefcnt += 1;
+	};
+	return (he);
+}
+
+
+/* This delete routine can't reclaim node, since pointers from hash
+table may be present.   */
+void VoronoiDiagramGenerator::ELdelete(int he)
+{
+	halfedges[halfedges[he].ELleft].ELright = halfedges[he].ELright;
+	halfedges[halfedges[he].ELright].ELleft = halfedges[he].ELleft;
+	halfedges[he].ELedge = DELETED;
+
+	if(beachLine == BEACHLINE_TREAP)
+		ELtreapdelete(he);
+}
+
+/* The treap holds the beach line in the same order as the linked list.
+Every halfedge left of a point is right_of it, so the halfedge bounding
+the point on the left is the last one on the way down that the point is
+right of. */
+int VoronoiDiagramGenerator::ELtreapleftbnd(struct Point *p)
+{
+	int he = ELleftend, node = ELroot;
+
+	while(node != NIL)
+	{
+		if(right_of(node, p))
+		{
+			he = node;
+			node = ELtreap[node].child[1];
+		}
+		else
+			node = ELtreap[node].child[0];
+	}
+
+	return (he);
+}
+
+void VoronoiDiagramGenerator::ELtreapinsert(int lb, int newHe)
+{
+	int parent;
+
+	ELseed ^= ELseed << 13;
+	ELseed ^= ELseed >> 17;
+	ELseed ^= ELseed << 5;
+	ELtreap[newHe].priority = ELseed;
+
+	/* the new halfedge goes right after lb, which is either straight below
+	it or at the far left of its right subtree */
+	if(ELroot == NIL)
+	{
+		ELroot = newHe;
+		return;
+	}
+
+	if(lb == ELleftend)
+		parent = ELroot;
+	else if(ELtreap[lb].child[1] == NIL)
+	{
+		ELtreap[lb].child[1] = newHe;
+		ELtreap[newHe].parent = lb;
+		parent = NIL;
+	}
+	else
+		parent = ELtreap[lb].child[1];
+
+	if(parent != NIL)
+	{
+		while(ELtreap[parent].child[0] != NIL)
+			parent = ELtreap[parent].child[0];
+
+		ELtreap[parent].child[0] = newHe;
+		ELtreap[newHe].parent = parent;
+	}
+
+	while(ELtreap[newHe].parent != NIL && ELtreap[ELtreap[newHe].parent].priority < ELtreap[newHe].priority)
+		ELrotateup(newHe);
+}
+
+void VoronoiDiagramGenerator::ELtreapdelete(int he)
+{
+	struct TreapNode &node = ELtreap[he];
+
+	/* rotate the halfedge down until it is a leaf, then cut it off */
+	while(node.child[0] != NIL || node.child[1] != NIL)
+	{
+		if(node.child[0] == NIL || 
+			(node.child[1] != NIL && ELtreap[node.child[1]].priority > ELtreap[node.child[0]].priority))
+			ELrotateup(node.child[1]);
+		else
+			ELrotateup(node.child[0]);
+	}
+
+	if(node.parent == NIL)
+		ELroot = NIL;
+	else
+		ELtreap[node.parent].child[ELtreap[node.parent].child[1] == he] = NIL;
+
+	node.parent = NIL;
+}
+
+void VoronoiDiagramGenerator::ELrotateup(int he)
+{
+	int parent = ELtreap[he].parent, grandparent = ELtreap[parent].parent;
+	int side = ELtreap[parent].child[1] == he;
+
+	ELtreap[parent].child[side] = ELtreap[he].child[!side];
+	if(ELtreap[parent].child[side] != NIL)
+		ELtreap[ELtreap[parent].child[side]].parent = parent;
+
+	ELtreap[he].child[!side] = parent;
+	ELtreap[parent].parent = he;
+
+	ELtreap[he].parent = grandparent;
+	if(grandparent == NIL)
+		ELroot = he;
+	else
+		ELtreap[grandparent].child[ELtreap[grandparent].child[1] == parent] = he;
+}
+
+
+int VoronoiDiagramGenerator::ELright(int he)
+{
+	return (halfedges[he].ELright);
+}
+
+int VoronoiDiagramGenerator::ELleft(int he)
+{
+	return (halfedges[he].ELleft);
+}
+
+
+int VoronoiDiagramGenerator::leftreg(int he)
+{
+	if(halfedges[he].ELedge == NIL) 
+		return(bottomsite);
+	return( halfedges[he].ELpm == le ? 
+		edges[halfedges[he].ELedge].reg[le] : edges[halfedges[he].ELedge].reg[re]);
+}
+
+int VoronoiDiagramGenerator::rightreg(int he)
+{
+	if(halfedges[he].ELedge == NIL) //if this halfedge has no edge, return the bottom site (whatever that is)
+		return(bottomsite);
+
+	//if the ELpm field is zero, return the site 0 that this edge bisects, otherwise return site number 1
+	return( halfedges[he].ELpm == le ? edges[halfedges[he].ELedge].reg[re] : edges[halfedges[he].ELedge].reg[le]);
+}
+
+void VoronoiDiagramGenerator::geominit()
+{	
+	float sn;
+
+	freeinit(&efl);
+	edges.clear();
+	nvertices = 0;
+	nedges = 0;
+	sn = (float)nsites+4;
+	sqrt_nsites = (int)sqrt(sn);
+	deltay = ymax - ymin;
+	deltax = xmax - xmin;
+}
+
+
+int VoronoiDiagramGenerator::bisect(int s1,int s2)
+{
+	float dx,dy,adx,ady;
+	int answer = getfree(edges, &efl, &Edge::edgenbr);
+	struct Edge &newedge = edges[answer];
+	
+	newedge.reg[0] = s1; //store the sites that this edge is bisecting
+	newedge.reg[1] = s2;
+	ref(s1); 
+	ref(s2);
+	newedge.ep[0] = NIL; //to begin with, there are no endpoints on the bisector - it goes to infinity
+	newedge.ep[1] = NIL;
+	
+	dx = sites[s2].coord.x - sites[s1].coord.x;			//get the difference in x dist between the sites
+	dy = sites[s2].coord.y - sites[s1].coord.y;
+	adx = dx>0 ? dx : -dx;					//make sure that the difference in positive
+	ady = dy>0 ? dy : -dy;
+	newedge.c = (float)(sites[s1].coord.x * dx + sites[s1].coord.y * dy + (dx*dx + dy*dy)*0.5);//get the slope of the line
+
+	if (adx>ady)
+	{	
+		newedge.a = 1.0; newedge.b = dy/dx; newedge.c /= dx;//set formula of line, with x fixed to 1
+	}
+	else
+	{	
+		newedge.b = 1.0; newedge.a = dx/dy; newedge.c /= dy;//set formula of line, with y fixed to 1
+	};
+	
+	newedge.edgenbr = nedges;
+
+	//printf("\nbisect(%d) ((%f,%f) and (%f,%f)",nedges,s1->coord.x,s1->coord.y,s2->coord.x,s2->coord.y);
+	
+	nedges += 1;
+	return(answer);
+}
+
+//create a new site where the HalfEdges el1 and el2 intersect
+int VoronoiDiagramGenerator::intersect(int el1, int el2)
+{
+	int e1, e2, e;
+	int el;
+	float d, xint, yint;
+	int right_of_site;
+	int v;
+	
+	e1 = halfedges[el1].ELedge;
+	e2 = halfedges[el2].ELedge;
+	if(e1 == NIL || e2 == NIL) 
+		return (NIL);
+
+	struct Edge &edge1 = edges[e1], &edge2 = edges[e2];
+
+	//if the two edges bisect the same parent, return null
+	if (edge1.reg[1] == edge2.reg[1]) 
+		return (NIL);
+	
+	d = edge1.a * edge2.b - edge1.b * edge2.a;
+	if (-1.0e-10<d && d<1.0e-10) 
+		return (NIL);
+	
+	xint = (edge1.c*edge2.b - edge2.c*edge1.b)/d;
+	yint = (edge2.c*edge1.a - edge1.c*edge2.a)/d;
+	
+	struct Point &top1 = sites[edge1.reg[1]].coord, &top2 = sites[edge2.reg[1]].coord;
+	if( (top1.y < top2.y) ||
+		(top1.y == top2.y &&
+		top1.x < top2.x) )
+	{	
+		el = el1; 
+		e = e1;
+	}
+	else
+	{	
+		el = el2; 
+		e = e2;
+	};
+	
+	right_of_site = xint >= sites[edges[e].reg[1]].coord.x;
+	if ((right_of_site && halfedges[el].ELpm == le) || (!right_of_site && halfedges[el].ELpm == re)) 
+		return (NIL);
+	
+	//create a new site at the point of intersection - this is a new vector event waiting to happen
+	v = getfree(sites, &sfl, &Site::sitenbr);
+	sites[v].refcnt = 0;
+	sites[v].coord.x = xint;
+	sites[v].coord.y = yint;
+	return(v);
+}
+
+/* returns 1 if p is to right of halfedge e */
+int VoronoiDiagramGenerator::right_of(int el,struct VoronoiDiagramGenerator::Point *p)
+{
+	struct Edge *e;
+	struct Site *topsite;
+	int right_of_site, above, fast;
+	float dxp, dyp, dxs, t1, t2, t3, yl;
+	
+	e = &edges[halfedges[el].ELedge];
+	topsite = &sites[e -> reg[1]];
+	right_of_site = p -> x > topsite -> coord.x;
+	if(right_of_site && halfedges[el].ELpm == le) return(1);
+	if(!right_of_site && halfedges[el].ELpm == re) return (0);
+	
+	if (e->a == 1.0)
+	{	dyp = p->y - topsite->coord.y;
+	dxp = p->x - topsite->coord.x;
+	fast = 0;
+	if ((!right_of_site & (e->b<0.0)) | (right_of_site & (e->b>=0.0)) )
+	{	above = dyp>= e->b*dxp;	
+	fast = above;
+	}
+	else 
+	{	above = p->x + p->y*e->b > e-> c;
+	if(e->b<0.0) above = !above;
+	if (!above) fast = 1;
+	};
+	if (!fast)
+	{	dxs = topsite->coord.x - sites[e->reg[0]].coord.x;
+	above = e->b * (dxp*dxp - dyp*dyp) <
+		dxs*dyp*(1.0+2.0*dxp/dxs + e->b*e->b);
+	if(e->b<0.0) above = !above;
+	};
+	}
+	else  /*e->b==1.0 */
+	{	yl = e->c - e->a*p->x;
+	t1 = p->y - yl;
+	t2 = p->x - topsite->coord.x;
+	t3 = yl - topsite->coord.y;
+	above = t1*t1 > t2*t2 + t3*t3;
+	};
+	return (halfedges[el].ELpm==le ? above : !above);
+}
+
+
+void VoronoiDiagramGenerator::endpoint(int e,int lr,int s)
+{
+	edges[e].ep[lr] = s;
+	ref(s);
+	if(edges[e].ep[re-lr]== NIL) 
+		return;
+
+	clip_line(e);
+
+	deref(edges[e].reg[le]);
+	deref(edges[e].reg[re]);
+	makefree(edges, &efl, &Edge::edgenbr, e);
+}
+
+
+float VoronoiDiagramGenerator::dist(int s,int t)
+{
+	float dx,dy;
+	dx = sites[s].coord.x - sites[t].coord.x;
+	dy = sites[s].coord.y - sites[t].coord.y;
+	return (float)(sqrt(dx*dx + dy*dy));
+}
+
+
+void VoronoiDiagramGenerator::makevertex(int v)
+{
+	sites[v].sitenbr = nvertices;
+	nvertices += 1;
+	out_vertex(v);
+}
+
+
+void VoronoiDiagramGenerator::deref(int v)
+{
+	sites[v].refcnt -= 1;
+	if (sites[v].refcnt == 0 ) 
+		makefree(sites, &sfl, &Site::sitenbr, v);
+}
+
+void VoronoiDiagramGenerator::ref(int v)
+{
+	sites[v].refcnt += 1;
+}
+
+//push the HalfEdge into the ordered linked list of vertices
+void VoronoiDiagramGenerator::PQinsert(int he,int v, float offset)
+{
+	int *last, next;
+	
+	halfedges[he].vertex = v;
+	ref(v);
+	halfedges[he].ystar = (float)(sites[v].coord.y + offset);
+
+	if(eventQueue == EVENTQUEUE_HEAP)
+	{
+		struct PQEntry entry = { halfedges[he].ystar, sites[v].coord.x, he };
+		halfedges[he].PQindex = (int)PQheap.size();
+		PQheap.push_back(entry);
+		PQheapup(halfedges[he].PQindex);
+		PQcount += 1;
+		return;
+	}
+
+	last = &PQhash[PQbucket(he)];
+	while ((next = *last) != NIL &&
+		(halfedges[he].ystar  > halfedges[next].ystar  ||
+		(halfedges[he].ystar == halfedges[next].ystar && sites[v].coord.x > sites[halfedges[next].vertex].coord.x)))
+	{	
+		last = &halfedges[next].PQnext;
+	};
+	halfedges[he].PQnext = *last; 
+	*last = he;
+	PQcount += 1;
+}
+
+//remove the HalfEdge from the list of vertices 
+void VoronoiDiagramGenerator::PQdelete(int he)
+{
+	int *last;
+	
+	if(halfedges[he].vertex != NIL)
+	{	
+		if(eventQueue == EVENTQUEUE_HEAP)
+			PQheapremove(halfedges[he].PQindex);
+		else
+		{
+			last = &PQhash[PQbucket(he)];
+			while (*last != he) 
+				last = &halfedges[*last].PQnext;
+
+			*last = halfedges[he].PQnext;
+		}
+		PQcount -= 1;
+		deref(halfedges[he].vertex);
+		halfedges[he].vertex = NIL;
+	};
+}
+
+int VoronoiDiagramGenerator::PQbucket(int he)
+{
+	int bucket;
+	
+	bucket = (int)((halfedges[he].ystar - ymin)/deltay * PQhashsize);
+	if (bucket<0) bucket = 0;
+	if (bucket>=PQhashsize) bucket = PQhashsize-1 ;
+	if (bucket < PQmin) PQmin = bucket;
+	return(bucket);
+}
+
+
+
+int VoronoiDiagramGenerator::PQempty()
+{
+	return(PQcount==0);
+}
+
+
+struct VoronoiDiagramGenerator::Point VoronoiDiagramGenerator::PQ_min()
+{
+	struct Point answer;
+
+	if(eventQueue == EVENTQUEUE_HEAP)
+	{
+		answer.x = PQheap[0].x;
+		answer.y = PQheap[0].ystar;
+		return (answer);
+	}
+	
+	while(PQhash[PQmin] == NIL) {PQmin += 1;};
+	answer.x = sites[halfedges[PQhash[PQmin]].vertex].coord.x;
+	answer.y = halfedges[PQhash[PQmin]].ystar;
+	return (answer);
+}
+
+int VoronoiDiagramGenerator::PQextractmin()
+{
+	int curr;
+
+	if(eventQueue == EVENTQUEUE_HEAP)
+	{
+		curr = PQheap[0].he;
+		PQheapremove(0);
+		PQcount -= 1;
+		return(curr);
+	}
+	
+	curr = PQhash[PQmin];
+	PQhash[PQmin] = halfedges[curr].PQnext;
+	PQcount -= 1;
+	return(curr);
+}
+
+
+bool VoronoiDiagramGenerator::PQinitialize()
+{
+	int i; 
+	
+	PQcount = 0;
+	PQmin = 0;
+
+	if(eventQueue == EVENTQUEUE_HEAP)
+	{
+		PQheap.clear();
+		return true;
+	}
+
+	PQhashsize = 4 * sqrt_nsites;
+	PQhash = (int *) myalloc(PQhashsize * sizeof *PQhash);
+
+	if(PQhash == 0)
+		return false;
+
+	for(i=0; i<PQhashsize; i+=1) PQhash[i] = NIL;
+
+	return true;
+}
+
+
+/* events are ordered by the y of the sweep line at which they happen, then by x */
+bool VoronoiDiagramGenerator::PQless(const struct PQEntry &a, const struct PQEntry &b)
+{
+	return a.ystar < b.ystar || (a.ystar == b.ystar && a.x < b.x);
+}
+
+void VoronoiDiagramGenerator::PQheapup(int i)
+{
+	struct PQEntry entry = PQheap[i];
+
+	while(i > 0 && PQless(entry, PQheap[(i - 1) / 2]))
+	{
+		PQheap[i] = PQheap[(i - 1) / 2];
+		halfedges[PQheap[i].he].PQindex = i;
+		i = (i - 1) / 2;
+	}
+
+	PQheap[i] = entry;
+	halfedges[entry.he].PQindex = i;
+}
+
+void VoronoiDiagramGenerator::PQheapdown(int i)
+{
+	struct PQEntry entry = PQheap[i];
+	int n = (int)PQheap.size();
+
+	while(2 * i + 1 < n)
+	{
+		int child = 2 * i + 1;
+		if(child + 1 < n && PQless(PQheap[child + 1], PQheap[child]))
+			child++;
+
+		if(!PQless(PQheap[child], entry))
+			break;
+
+		PQheap[i] = PQheap[child];
+		halfedges[PQheap[i].he].PQindex = i;
+		i = child;
+	}
+
+	PQheap[i] = entry;
+	halfedges[entry.he].PQindex = i;
+}
+
+void VoronoiDiagramGenerator::PQheapremove(int i)
+{
+	struct PQEntry last = PQheap.back();
+
+	PQheap.pop_back();
+	if(i < (int)PQheap.size())
+	{
+		PQheap[i] = last;
+		halfedges[last.he].PQindex = i;
+		PQheapup(i);
+		PQheapdown(halfedges[last.he].PQindex);
+	}
+}
+
+void VoronoiDiagramGenerator::cleanup()
+{
+	// only the blocks which did not fit in the arena are on the heap
+	FreeNodeArrayList* current = allMemoryList->next, *next = 0;
+
+	while(current != 0)
+	{
+		next = current->next;
+		free(current->memory);
+		delete current;
+		current = next;
+	}
+
+	allMemoryList->next = 0;
+	currentMemoryBlock = allMemoryList;
+}
+
+void VoronoiDiagramGenerator::cleanupEdges()
+{
+	// the arrays keep their capacity for the next diagram
+	allEdges.x1.clear();
+	allEdges.y1.clear();
+	allEdges.x2.clear();
+	allEdges.y2.clear();
+	allEdges.site1.clear();
+	allEdges.site2.clear();
+	allEdges.next1.clear();
+	allEdges.next2.clear();
+	iteratorEdges = 0;
+}
+
+void VoronoiDiagramGenerator::reserve(int numPoints)
+{
+	// a diagram of n sites has at most 2n vertices and 3n edges, every edge
+	// has a halfedge on either side, and the beach line and the event queue
+	// never hold more halfedges than that
+	size_t n = numPoints > 0 ? (size_t)numPoints : 0;
+	size_t maxEdges = 3 * n + 3, maxHalfedges = 2 * maxEdges + 2;
+
+	sites.reserve(3 * n);
+	sitePoints.reserve(n);
+	sortOrder.reserve(n);
+	radixKeys.reserve(n);
+	radixBuffer.reserve(n);
+	siteBuffer.reserve(n);
+	edges.reserve(maxEdges);
+	halfedges.reserve(maxHalfedges);
+
+	if(beachLine == BEACHLINE_TREAP)
+		ELtreap.reserve(maxHalfedges);
+	if(eventQueue == EVENTQUEUE_HEAP)
+		PQheap.reserve(maxHalfedges);
+
+	allEdges.x1.reserve(maxEdges);
+	allEdges.y1.reserve(maxEdges);
+	allEdges.x2.reserve(maxEdges);
+	allEdges.y2.reserve(maxEdges);
+	allEdges.site1.reserve(maxEdges);
+	allEdges.site2.reserve(maxEdges);
+
+	if(cellCallback)
+	{
+		allEdges.next1.reserve(maxEdges);
+		allEdges.next2.reserve(maxEdges);
+		arcCounts.reserve(n);
+		cellFirstEdge.reserve(n);
+		cellLastEdge.reserve(n);
+	}
+
+	// every side of a ring adds at most one more vertex where it runs along
+	// the box, and the box adds its four corners
+	if(closedCells)
+	{
+		cellEdgeOffsets.reserve(n + 1);
+		cellEdgeList.reserve(2 * maxEdges);
+		cellEdgeFill.reserve(n);
+		allCells.offsets.reserve(n + 1);
+		allCells.x.reserve(4 * maxEdges + 4);
+		allCells.y.reserve(4 * maxEdges + 4);
+		allCells.neighbour.reserve(4 * maxEdges + 4);
+	}
+
+	// the beach line and event queue hashes are carved out of the arena
+	int sqrtSites = (int)sqrt((float)(n + 4));
+	int hashes = ((2 * sqrtSites * (int)sizeof(int) + 15) & ~15) + ((4 * sqrtSites * (int)sizeof(int) + 15) & ~15);
+	if(hashes > arenaSize)
+	{
+		free(arena);
+		arenaSize = hashes;
+		arena = (char*)malloc(arenaSize);
+
+		if(arena == 0)
+			arenaSize = 0;
+	}
+}
+
+void VoronoiDiagramGenerator::resetArena()
+{
+	// grow the arena (with some slack) if the last diagram spilled out of it
+	if(total_alloc > arenaSize)
+	{
+		free(arena);
+		arenaSize = total_alloc + total_alloc / 8;
+		arena = (char*)malloc(arenaSize);
+
+		if(arena == 0)
+			arenaSize = 0;
+	}
+
+	arenaUsed = 0;
+	total_alloc = 0;
+}
+
+void VoronoiDiagramGenerator::pushGraphEdge(float x1, float y1, float x2, float y2, int s1, int s2)
+{
+	allEdges.x1.push_back(x1);
+	allEdges.y1.push_back(y1);
+	allEdges.x2.push_back(x2);
+	allEdges.y2.push_back(y2);
+	allEdges.site1.push_back(s1);
+	allEdges.site2.push_back(s2);
+
+	if(!cellCallback)
+		return;
+
+	// append the edge to the chains of both of its sites
+	int e = (int)allEdges.site1.size() - 1;
+	int s[2] = { s1, s2 };
+
+	allEdges.next1.push_back(NIL);
+	allEdges.next2.push_back(NIL);
+
+	for(int k = 0; k < 2; k++)
+	{
+		int last = cellLastEdge[s[k]];
+
+		if(last == NIL)
+			cellFirstEdge[s[k]] = e;
+		else if(allEdges.site1[last] == s[k])
+			allEdges.next1[last] = e;
+		else
+			allEdges.next2[last] = e;
+
+		cellLastEdge[s[k]] = e;
+	}
+}
+
+
+char * VoronoiDiagramGenerator::myalloc(unsigned n)
+{
+	char *t=0;	
+
+	n = (n + 15) & ~15u;
+	total_alloc += n;
+
+	if(arenaUsed + (int)n <= arenaSize)
+	{
+		t = arena + arenaUsed;
+		arenaUsed += n;
+		return(t);
+	}
+
+	// the arena is full, so fall back to the heap until the next diagram
+	t=(char*)malloc(n);
+
+	if(t == 0)
+		return 0;
+
+	currentMemoryBlock->next = new FreeNodeArrayList;
+	currentMemoryBlock = currentMemoryBlock->next;
+	currentMemoryBlock->memory = (Freenode*)t;
+	currentMemoryBlock->next = 0;
+
+	return(t);
+}
+
+
+/* for those who don't have Cherry's plot */
+/* #include <plot.h> */
+void VoronoiDiagramGenerator::openpl(){}
+void VoronoiDiagramGenerator::line(float x1, float y1, float x2, float y2, int s1, int s2)
+{	
+	pushGraphEdge(x1,y1,x2,y2, s1, s2);
+
+}
+void VoronoiDiagramGenerator::circle(float x, float y, float radius){}
+void VoronoiDiagramGenerator::range(float minX, float minY, float maxX, float maxY){}
+
+
+
+void VoronoiDiagramGenerator::out_bisector(int e)
+{
+	
+
+}
+
+
+void VoronoiDiagramGenerator::out_ep(int e)
+{
+	
+	
+}
+
+void VoronoiDiagramGenerator::out_vertex(int v)
+{
+	
+}
+
+
+void VoronoiDiagramGenerator::out_site(int s)
+{
+	if(!triangulate && plot && !debug)
+		circle (sites[s].coord.x, sites[s].coord.y, cradius);
+	
+}
+
+
+void VoronoiDiagramGenerator::out_triple(int s1, int s2,int s3)
+{
+	
+}
+
+
+
+void VoronoiDiagramGenerator::plotinit()
+{
+	float dx,dy,d;
+	
+	dy = ymax - ymin;
+	dx = xmax - xmin;
+	d = (float)(( dx > dy ? dx : dy) * 1.1);
+	pxmin = (float)(xmin - (d-dx)/2.0);
+	pxmax = (float)(xmax + (d-dx)/2.0);
+	pymin = (float)(ymin - (d-dy)/2.0);
+	pymax = (float)(ymax + (d-dy)/2.0);
+	cradius = (float)((pxmax - pxmin)/350.0);
+	openpl();
+	range(pxmin, pymin, pxmax, pymax);
+}
+
+
+void VoronoiDiagramGenerator::clip_line(int edge)
+{
+	struct Edge *e = &edges[edge];
+	struct Site *s1, *s2;
+	float x1=0,x2=0,y1=0,y2=0;
+
+	x1 = sites[e->reg[0]].coord.x;
+	x2 = sites[e->reg[1]].coord.x;
+	y1 = sites[e->reg[0]].coord.y;
+	y2 = sites[e->reg[1]].coord.y;
+
+
+	//if the distance between the two points this line was created from is less than 
+	//the square root of 2, then ignore it
+	if(sqrt(((x2 - x1) * (x2 - x1)) + ((y2 - y1) * (y2 - y1))) < minDistanceBetweenSites)
+//	if ( abs(x2-x1) + abs(y2-y1) < minDistanceBetweenSites )
+	{
+		return;
+	}
+	pxmin = borderMinX;
+	pxmax = borderMaxX;
+	pymin = borderMinY;
+	pymax = borderMaxY;
+
+	if(e -> a == 1.0 && e ->b >= 0.0)
+	{	
+		s1 = e -> ep[1] != NIL ? &sites[e -> ep[1]] : (struct Site *)NULL;
+		s2 = e -> ep[0] != NIL ? &sites[e -> ep[0]] : (struct Site *)NULL;
+	}
+	else 
+	{
+		s1 = e -> ep[0] != NIL ? &sites[e -> ep[0]] : (struct Site *)NULL;
+		s2 = e -> ep[1] != NIL ? &sites[e -> ep[1]] : (struct Site *)NULL;
+	};
+	
+	if(e -> a == 1.0)
+	{
+		y1 = pymin;
+		if (s1!=(struct Site *)NULL && s1->coord.y > pymin)
+		{
+			y1 = s1->coord.y;
+		}
+		if(y1>pymax) 
+		{
+		//	printf("\nClipped (1) y1 = %f to %f",y1,pymax);
+			y1 = pymax;
+			//return;
+		}
+		x1 = e -> c - e -> b * y1;
+		y2 = pymax;
+		if (s2!=(struct Site *)NULL && s2->coord.y < pymax) 
+			y2 = s2->coord.y;
+
+		if(y2<pymin) 
+		{
+			//printf("\nClipped (2) y2 = %f to %f",y2,pymin);
+			y2 = pymin;
+			//return;
+		}
+		x2 = (e->c) - (e->b) * y2;
+		if (((x1> pxmax) & (x2>pxmax)) | ((x1<pxmin)&(x2<pxmin))) 
+		{
+			//printf("\nClipLine jumping out(3), x1 = %f, pxmin = %f, pxmax = %f",x1,pxmin,pxmax);
+			return;
+		}
+		if(x1> pxmax)
+		{	x1 = pxmax; y1 = (e -> c - x1)/e -> b;};
+		if(x1<pxmin)
+		{	x1 = pxmin; y1 = (e -> c - x1)/e -> b;};
+		if(x2>pxmax)
+		{	x2 = pxmax; y2 = (e -> c - x2)/e -> b;};
+		if(x2<pxmin)
+		{	x2 = pxmin; y2 = (e -> c - x2)/e -> b;};
+	}
+	else
+	{
+		x1 = pxmin;
+		if (s1!=(struct Site *)NULL && s1->coord.x > pxmin) 
+			x1 = s1->coord.x;
+		if(x1>pxmax) 
+		{
+			//printf("\nClipped (3) x1 = %f to %f",x1,pxmin);
+			//return;
+			x1 = pxmax;
+		}
+		y1 = e -> c - e -> a * x1;
+		x2 = pxmax;
+		if (s2!=(struct Site *)NULL && s2->coord.x < pxmax) 
+			x2 = s2->coord.x;
+		if(x2<pxmin) 
+		{
+			//printf("\nClipped (4) x2 = %f to %f",x2,pxmin);
+			//return;
+			x2 = pxmin;
+		}
+		y2 = e -> c - e -> a * x2;
+		if (((y1> pymax) & (y2>pymax)) | ((y1<pymin)&(y2<pymin))) 
+		{
+			//printf("\nClipLine jumping out(6), y1 = %f, pymin = %f, pymax = %f",y2,pymin,pymax);
+			return;
+		}
+		if(y1> pymax)
+		{	y1 = pymax; x1 = (e -> c - y1)/e -> a;};
+		if(y1<pymin)
+		{	y1 = pymin; x1 = (e -> c - y1)/e -> a;};
+		if(y2>pymax)
+		{	y2 = pymax; x2 = (e -> c - y2)/e -> a;};
+		if(y2<pymin)
+		{	y2 = pymin; x2 = (e -> c - y2)/e -> a;};
+	};
+	
+	//printf("\nPushing line (%f,%f,%f,%f)",x1,y1,x2,y2);
+	line(x1,y1,x2,y2, sites[e->reg[0]].sitenbr, sites[e->reg[1]].sitenbr );
+}
+
+
+/* implicit parameters: nsites, sqrt_nsites, xmin, xmax, ymin, ymax,
+deltax, deltay (can all be estimates).
+Performance suffers if they are wrong; better to make nsites,
+deltax, and deltay too big than too small.  (?) */
+
+bool VoronoiDiagramGenerator::voronoi(int triangulate)
+{
+	int newsite, bot, top, mid, midnbr, temp, p;
+	int v;
+	struct Point newintstar;
+	int pm;
+	int lbnd, rbnd, llbnd, rrbnd, bisector;
+	int e;
+	
+	PQinitialize();
+	bottomsite = nextone();
+	out_site(bottomsite);
+	bool retval = ELinitialize();
+
+	if(!retval)
+		return false;
+
+	if(cellCallback)
+		arcCounts[bottomsite] = 1;
+	
+	newsite = nextone();
+	while(1)
+	{
+
+		if(!PQempty()) 
+			newintstar = PQ_min();
+		
+		//if the lowest site has a smaller y value than the lowest vector intersection, process the site
+		//otherwise process the vector intersection		
+
+		if (newsite != NIL 	&& (PQempty() || sites[newsite].coord.y < newintstar.y
+			|| (sites[newsite].coord.y == newintstar.y && sites[newsite].coord.x < newintstar.x)))
+		{/* new site is smallest - this is a site event*/
+			out_site(newsite);						//output the site
+			struct Point newcoord = sites[newsite].coord;
+			lbnd = ELleftbnd(&newcoord);				//get the first HalfEdge to the LEFT of the new site
+			rbnd = ELright(lbnd);						//get the first HalfEdge to the RIGHT of the new site
+			bot = rightreg(lbnd);						//if this halfedge has no edge, , bot = bottom site (whatever that is)
+			e = bisect(bot, newsite);					//create a new edge that bisects 
+			bisector = HEcreate(e, le);					//create a new HalfEdge, setting its ELpm field to 0			
+			ELinsert(lbnd, bisector);					//insert this new bisector edge between the left and right vectors in a linked list	
+
+			if ((p = intersect(lbnd, bisector)) != NIL) 	//if the new bisector intersects with the left edge, remove the left edge's vertex, and put in the new one
+			{	
+				PQdelete(lbnd);
+				PQinsert(lbnd, p, dist(p,newsite));
+			};
+			lbnd = bisector;						
+			bisector = HEcreate(e, re);					//create a new HalfEdge, setting its ELpm field to 1
+			ELinsert(lbnd, bisector);					//insert the new HE to the right of the original bisector earlier in the IF stmt
+
+			if ((p = intersect(bisector, rbnd)) != NIL)	//if this new bisector intersects with the
+			{	
+				PQinsert(bisector, p, dist(p,newsite));			//push the HE into the ordered linked list of vertices
+			};
+
+			if (cellCallback)							//the new site split the arc of bot in two
+			{
+				arcCounts[bot]++;
+				arcCounts[newsite] = 1;
+			}
+			newsite = nextone();	
+		}
+		else if (!PQempty()) /* intersection is smallest - this is a vector event */			
+		{	
+			lbnd = PQextractmin();						//pop the HalfEdge with the lowest vector off the ordered list of vectors				
+			llbnd = ELleft(lbnd);						//get the HalfEdge to the left of the above HE
+			rbnd = ELright(lbnd);						//get the HalfEdge to the right of the above HE
+			rrbnd = ELright(rbnd);						//get the HalfEdge to the right of the HE to the right of the lowest HE 
+			bot = leftreg(lbnd);						//get the Site to the left of the left HE which it bisects
+			top = rightreg(rbnd);						//get the Site to the right of the right HE which it bisects
+
+			mid = rightreg(lbnd);						//get the Site whose arc vanishes between the two HEs
+			midnbr = sites[mid].sitenbr;				//and its number, before the endpoints can free it
+			out_triple(bot, top, mid);					//output the triple of sites, stating that a circle goes through them
+
+			v = halfedges[lbnd].vertex;						//get the vertex that caused this event
+			makevertex(v);							//set the vertex number - couldn't do this earlier since we didn't know when it would be processed
+			endpoint(halfedges[lbnd].ELedge,halfedges[lbnd].ELpm,v);	//set the endpoint of the left HalfEdge to be this vector
+			endpoint(halfedges[rbnd].ELedge,halfedges[rbnd].ELpm,v);	//set the endpoint of the right HalfEdge to be this vector
+			ELdelete(lbnd);							//mark the lowest HE for deletion - can't delete yet because there might be pointers to it in Hash Map	
+			PQdelete(rbnd);							//remove all vertex events to do with the  right HE
+			ELdelete(rbnd);							//mark the right HE for deletion - can't delete yet because there might be pointers to it in Hash Map	
+			pm = le;								//set the pm variable to zero
+			
+			if (sites[bot].coord.y > sites[top].coord.y)		//if the site to the left of the event is higher than the Site
+			{										//to the right of it, then swap them and set the 'pm' variable to 1
+				temp = bot; 
+				bot = top; 
+				top = temp; 
+				pm = re;
+			}
+			e = bisect(bot, top);					//create an Edge (or line) that is between the two Sites. This creates
+													//the formula of the line, and assigns a line number to it
+			bisector = HEcreate(e, pm);				//create a HE from the Edge 'e', and make it point to that edge with its ELedge field
+			ELinsert(llbnd, bisector);				//insert the new bisector to the right of the left HE
+			endpoint(e, re-pm, v);					//set one endpoint to the new edge to be the vector point 'v'.
+													//If the site to the left of this bisector is higher than the right
+													//Site, then this endpoint is put in position 0; otherwise in pos 1
+			deref(v);								//delete the vector 'v'
+
+			//if left HE and the new bisector don't intersect, then delete the left HE, and reinsert it 
+			if((p = intersect(llbnd, bisector)) != NIL)
+			{	
+				PQdelete(llbnd);
+				PQinsert(llbnd, p, dist(p,bot));
+			};
+
+			//if right HE and the new bisector don't intersect, then reinsert it 
+			if ((p = intersect(bisector, rrbnd)) != NIL)
+			{	
+				PQinsert(bisector, p, dist(p,bot));
+			};
+
+			//both edges which ended here were the last open ones of the cell if this was its last arc
+			if (cellCallback && --arcCounts[mid] == 0)
+				cellCallback(cellContext, midnbr);
+		}
+		else break;
+	};
+
+	
+
+
+	// an edge that never got an endpoint still has both of its halfedges on
+	// the beach line, so mark it to keep from clipping it twice
+	for(lbnd=ELright(ELleftend); lbnd != ELrightend; lbnd=ELright(lbnd))
+	{	
+		e = halfedges[lbnd].ELedge;
+
+		if(edges[e].edgenbr < 0)
+			continue;
+
+		clip_line(e);
+		edges[e].edgenbr = -1;
+	};
+
+	// the cells still on the beach line are open towards the outside, and
+	// only complete now
+	for(int s = 0; cellCallback && s < nsites; s++)
+	{
+		if(arcCounts[s] > 0)
+			cellCallback(cellContext, sites[s].sitenbr);
+	}
+
+	return true;
+	
+}
+
+
+int scomp(const void *p1,const void *p2)
+{
+	struct VoronoiDiagramGenerator::Point *s1 = (VoronoiDiagramGenerator::Point*)p1, *s2=(VoronoiDiagramGenerator::Point*)p2;
+	if(s1 -> y < s2 -> y) return(-1);
+	if(s1 -> y > s2 -> y) return(1);
+	if(s1 -> x < s2 -> x) return(-1);
+	if(s1 -> x > s2 -> x) return(1);
+	return(0);
+}
+
+/* return a single in-storage site */
+int VoronoiDiagramGenerator::nextone()
+{
+	if(siteidx < nsites)
+	{	
+		siteidx += 1;
+		return(siteidx - 1);
+	}
+	else	
+		return(NIL);
+}
+
@@ -1,256 +1,440 @@
-/*
-* The author of this software is Steven Fortune.  Copyright (c) 1994 by AT&T
-* Bell Laboratories.
-* Permission to use, copy, modify, and distribute this software for any
-* purpose without fee is hereby granted, provided that this entire notice
-* is included in all copies of any software which is or includes a copy
-* or modification of this software and in all copies of the supporting
-* documentation for such software.
-* THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
-* WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR AT&T MAKE ANY
-* REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING THE MERCHANTABILITY
-* OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
-*/
-
-/* 
-* This code was originally written by Stephan Fortune in C code.  I, Shane O'Sullivan, 
-* have since modified it, encapsulating it in a C++ class and, fixing memory leaks and 
-* adding accessors to the Voronoi Edges.
-* Permission to use, copy, modify, and distribute this software for any
-* purpose without fee is hereby granted, provided that this entire notice
-* is included in all copies of any software which is or includes a copy
-* or modification of this software and in all copies of the supporting
-* documentation for such software.
-* THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
-* WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR AT&T MAKE ANY
-* REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING THE MERCHANTABILITY
-* OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
-*/
-
-#ifndef VORONOI_DIAGRAM_GENERATOR
-#define VORONOI_DIAGRAM_GENERATOR
-
-#include <math.h>
-#include <stdlib.h>
-#include <string.h>
-
-
-#ifndef NULL
-#define NULL 0
-#endif
-#define DELETED -2
-
-#define le 0
-#define re 1
-
-
-
-
-
-
-
-class VoronoiDiagramGenerator
-{
-public:
-	struct	Freenode	
-{
-	struct	Freenode *nextfree;
-};
-
-struct FreeNodeArrayList
-{
-	struct	Freenode* memory;
-	struct	FreeNodeArrayList* next;
-
-};
-
-struct	Freelist	
-{
-	struct	Freenode	*head;
-	int		nodesize;
-};
-
-struct Point	
-{
-	float x,y;
-};
-
-// structure used both for sites and for vertices 
-struct Site	
-{
-	struct	Point	coord;
-	int		sitenbr;
-	int		refcnt;
-};
-
-
-
-struct Edge	
-{
-	float   a,b,c;
-	struct	Site 	*ep[2];
-	struct	Site	*reg[2];
-	int		edgenbr;
-
-};
-
-struct GraphEdge
-{
-	float x1,y1,x2,y2;
-	float s1x, s1y, s2x, s2y;
-	struct GraphEdge* next;
-};
-
-
-
-
-struct Halfedge 
-{
-	struct	Halfedge	*ELleft, *ELright;
-	struct	Edge	*ELedge;
-	int		ELrefcnt;
-	char	ELpm;
-	struct	Site	*vertex;
-	float	ystar;
-	struct	Halfedge *PQnext;
-};
-
-public:
-	VoronoiDiagramGenerator();
-	~VoronoiDiagramGenerator();
-
-	bool generateVoronoi(float *xValues, float *yValues, int numPoints, float minX, float maxX, float minY, float maxY, float minDist=0);
-
-	void resetIterator()
-	{
-		iteratorEdges = allEdges;
-	}
-
-	bool getNext(float& x1, float& y1, float& x2, float& y2, float &s1x, float &s1y, float &s2x, float &s2y)
-	{
-		if(iteratorEdges == 0)
-			return false;
-		
-		x1 = iteratorEdges->x1;
-		x2 = iteratorEdges->x2;
-		y1 = iteratorEdges->y1;
-		y2 = iteratorEdges->y2;
-		s1x = iteratorEdges->s1x;
-		s1y = iteratorEdges->s1y;
-		s2x = iteratorEdges->s2x;
-		s2y = iteratorEdges->s2y;
-
-
-		iteratorEdges = iteratorEdges->next;
-
-		return true;
-	}
-
-
-private:
-	void cleanup();
-	void cleanupEdges();
-	char *getfree(struct Freelist *fl);	
-	struct	Halfedge *PQfind();
-	int PQempty();
-
-
-	
-	struct	Halfedge **ELhash;
-	struct	Halfedge *HEcreate(), *ELleft(), *ELright(), *ELleftbnd();
-	struct	Halfedge *HEcreate(struct Edge *e,int pm);
-
-
-	struct Point PQ_min();
-	struct Halfedge *PQextractmin();	
-	void freeinit(struct Freelist *fl,int size);
-	void makefree(struct Freenode *curr,struct Freelist *fl);
-	void geominit();
-	void plotinit();
-	bool voronoi(int triangulate);
-	void ref(struct Site *v);
-	void deref(struct Site *v);
-	void endpoint(struct Edge *e,int lr,struct Site * s);
-
-	void ELdelete(struct Halfedge *he);
-	struct Halfedge *ELleftbnd(struct Point *p);
-	struct Halfedge *ELright(struct Halfedge *he);
-	void makevertex(struct Site *v);
-	void out_triple(struct Site *s1, struct Site *s2,struct Site * s3);
-
-	void PQinsert(struct Halfedge *he,struct Site * v, float offset);
-	void PQdelete(struct Halfedge *he);
-	bool ELinitialize();
-	void ELinsert(struct	Halfedge *lb, struct Halfedge *newHe);
-	struct Halfedge * ELgethash(int b);
-	struct Halfedge *ELleft(struct Halfedge *he);
-	struct Site *leftreg(struct Halfedge *he);
-	void out_site(struct Site *s);
-	bool PQinitialize();
-	int PQbucket(struct Halfedge *he);
-	void clip_line(struct Edge *e);
-	char *myalloc(unsigned n);
-	int right_of(struct Halfedge *el,struct Point *p);
-
-	struct Site *rightreg(struct Halfedge *he);
-	struct Edge *bisect(struct	Site *s1,struct	Site *s2);
-	float dist(struct Site *s,struct Site *t);
-	struct Site *intersect(struct Halfedge *el1, struct Halfedge *el2, struct Point *p=0);
-
-	void out_bisector(struct Edge *e);
-	void out_ep(struct Edge *e);
-	void out_vertex(struct Site *v);
-	struct Site *nextone();
-
-	void pushGraphEdge(float x1, float y1, float x2, float y2, float s1x, float s1y, float s2x, float s2y);
-
-	void openpl();
-	void line(float x1, float y1, float x2, float y2,float s1x, float s1y, float s2x, float s2y);
-	void circle(float x, float y, float radius);
-	void range(float minX, float minY, float maxX, float maxY);
-
-
-	struct  Freelist	hfl;
-	struct	Halfedge *ELleftend, *ELrightend;
-	int 	ELhashsize;
-
-	int		triangulate, sorted, plot, debug;
-	float	xmin, xmax, ymin, ymax, deltax, deltay;
-
-	struct	Site	*sites;
-	int		nsites;
-	int		siteidx;
-	int		sqrt_nsites;
-	int		nvertices;
-	struct 	Freelist sfl;
-	struct	Site	*bottomsite;
-
-	int		nedges;
-	struct	Freelist efl;
-	int		PQhashsize;
-	struct	Halfedge *PQhash;
-	int		PQcount;
-	int		PQmin;
-
-	int		ntry, totalsearch;
-	float	pxmin, pxmax, pymin, pymax, cradius;
-	int		total_alloc;
-
-	float borderMinX, borderMaxX, borderMinY, borderMaxY;
-
-	FreeNodeArrayList* allMemoryList;
-	FreeNodeArrayList* currentMemoryBlock;
-
-	GraphEdge* allEdges;
-	GraphEdge* iteratorEdges;
-
-	float minDistanceBetweenSites;
-	
-};
-
-int scomp(const void *p1,const void *p2);
-
-
-#endif
-
-
+/*
+* The author of this software is Steven Fortune.  Copyright (c) 1994 by AT&T
+* Bell Laboratories.
+* Permission to use, copy, modify, and distribute this software for any
+* purpose without fee is hereby granted, provided that this entire notice
+* is included in all copies of any software which is or includes a copy
+* or modification of this software and in all copies of the supporting
+* documentation for such software.
+* THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
+* WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR AT&T MAKE ANY
+* REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING THE MERCHANTABILITY
+* OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
+*/
+
+/* 
+* This code was originally written by Stephan Fortune in C code.  I, Shane O'Sullivan, 
+* have since modified it, encapsulating it in a C++ class and, fixing memory leaks and 
+* adding accessors to the Voronoi Edges.
+* Permission to use, copy, modify, and distribute this software for any
+* purpose without fee is hereby granted, provided that this entire notice
+* is included in all copies of any software which is or includes a copy
+* or modification of this software and in all copies of the supporting
+* documentation for such software.
+* THIS SOFTWARE IS BEING PROVIDED "AS IS", WITHOUT ANY EXPRESS OR IMPLIED
+* WARRANTY.  IN PARTICULAR, NEITHER THE AUTHORS NOR AT&T MAKE ANY
+* REPRESENTATION OR WARRANTY OF ANY KIND CONCERNING THE MERCHANTABILITY
+* OF THIS SOFTWARE OR ITS FITNESS FOR ANY PARTICULAR PURPOSE.
+*/
+
+#ifndef VORONOI_DIAGRAM_GENERATOR
+#define VORONOI_DIAGRAM_GENERATOR
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+
+#ifndef NULL
+#define NULL 0
+#endif
+#define DELETED -2
+#define NIL -1
+
+#define le 0
+#define re 1
+
+
+
+
+
+
+
+class VoronoiDiagramGenerator
+{
+public:
+	struct	Freenode	
+{
+	struct	Freenode *nextfree;
+};
+
+struct FreeNodeArrayList
+{
+	struct	Freenode* memory;
+	struct	FreeNodeArrayList* next;
+
+};
+
+// the free entries of a pool, threaded through one of their fields
+struct	Freelist	
+{
+	int		head;
+};
+
+struct Point	
+{
+	float x,y;
+};
+
+// structure used both for sites and for vertices 
+struct Site	
+{
+	struct	Point	coord;
+	int		sitenbr;
+	int		refcnt;
+};
+
+
+
+// the sites, edges and halfedges refer to each other by their index in
+// the pools of the generator, with NIL standing in for a null pointer.
+// without 64 bit pointers an Edge and a Halfedge fit in 32 bytes each.
+struct Edge	
+{
+	float   a,b,c;
+	int		ep[2];
+	int		reg[2];
+	int		edgenbr;
+
+};
+
+// the output edges, stored as parallel arrays. site1 and site2 are the
+// indices (into the arrays given to generateVoronoi) of the sites on
+// either side of each edge. while a cell callback is set, next1 and next2
+// chain the edges of every site in the order they were found.
+struct GraphEdges
+{
+	std::vector<float> x1,y1,x2,y2;
+	std::vector<int> site1, site2;
+	std::vector<int> next1, next2;
+};
+
+// called with the index of a site as soon as the sweep has found every
+// edge of its cell
+typedef void (*CellCallback)(void *context, int site);
+
+// the cells as closed rings clipped to the bounding box, wound counter
+// clockwise (positive area). the ring of site i is vertices offsets[i] to
+// offsets[i + 1], side k runs from vertex k to vertex k + 1, and
+// neighbour[k] is the site across side k, or -1 along the bounding box.
+struct GraphCells
+{
+	std::vector<int> offsets;
+	std::vector<float> x, y;
+	std::vector<int> neighbour;
+};
+
+
+
+
+struct Halfedge 
+{
+	int		ELleft, ELright;
+	int		ELedge;
+	int		vertex;
+	float	ystar;
+
+	// the next event in the same bucket, or the slot in the event heap
+	union
+	{
+		int		PQnext;
+		int		PQindex;
+	};
+	int		ELrefcnt;
+	int		ELpm;
+};
+
+// an event in the heap, carrying its keys along so that comparing two
+// of them does not have to look up their halfedges and vertices
+struct PQEntry
+{
+	float	ystar, x;
+	int		he;
+};
+
+// links of the treap beach line, kept apart from the halfedges since they
+// are only needed with the treap
+struct TreapNode
+{
+	int		parent, child[2];
+	unsigned int priority;
+};
+
+// the structures the sweep keeps its beach line and its events in. the
+// buckets are fastest for evenly spread sites, but turn into linear
+// searches when the sites crowd together.
+enum BeachLine
+{
+	BEACHLINE_HASHED,
+	BEACHLINE_TREAP
+};
+
+enum EventQueue
+{
+	EVENTQUEUE_BUCKETED,
+	EVENTQUEUE_HEAP
+};
+
+public:
+	VoronoiDiagramGenerator();
+	~VoronoiDiagramGenerator();
+
+	bool generateVoronoi(float *xValues, float *yValues, int numPoints, float minX, float maxX, float minY, float maxY, float minDist=0);
+
+	void resetIterator()
+	{
+		iteratorEdges = 0;
+	}
+
+	bool getNext(float& x1, float& y1, float& x2, float& y2, float &s1x, float &s1y, float &s2x, float &s2y)
+	{
+		if(iteratorEdges >= (int)allEdges.x1.size())
+			return false;
+		
+		x1 = allEdges.x1[iteratorEdges];
+		x2 = allEdges.x2[iteratorEdges];
+		y1 = allEdges.y1[iteratorEdges];
+		y2 = allEdges.y2[iteratorEdges];
+		s1x = sitePoints[allEdges.site1[iteratorEdges]].x;
+		s1y = sitePoints[allEdges.site1[iteratorEdges]].y;
+		s2x = sitePoints[allEdges.site2[iteratorEdges]].x;
+		s2y = sitePoints[allEdges.site2[iteratorEdges]].y;
+
+		iteratorEdges++;
+
+		return true;
+	}
+
+	// all of the edges of the last diagram at once
+	const GraphEdges &getEdges()
+	{
+		return allEdges;
+	}
+
+	// bytes allocated while generating the last diagram
+	long getTotalAlloc()
+	{
+		return total_alloc + poolAlloc;
+	}
+
+	// seconds spent sorting the sites of the last diagram
+	float getSortTime()
+	{
+		return sortTime;
+	}
+
+	// grows the pools and outputs to fit a diagram of numPoints sites, so that
+	// generating one does not have to allocate
+	void reserve(int numPoints);
+
+	// also build closed cells out of the edges of every diagram
+	void setClosedCells(bool closedCells)
+	{
+		this->closedCells = closedCells;
+	}
+
+	const GraphCells &getCells()
+	{
+		return allCells;
+	}
+
+	void setStructures(BeachLine beachLine, EventQueue eventQueue)
+	{
+		this->beachLine = beachLine;
+		this->eventQueue = eventQueue;
+	}
+
+	// hand every cell to callback as soon as it is complete, rather than
+	// only once the whole diagram is. NULL turns it off again.
+	void setCellCallback(CellCallback callback, void *context)
+	{
+		cellCallback = callback;
+		cellContext = context;
+	}
+
+	// the edges of a completed cell, in the order they were found, ending
+	// with NIL
+	int getFirstCellEdge(int site)
+	{
+		return cellFirstEdge[site];
+	}
+
+	int getNextCellEdge(int edge, int site)
+	{
+		return allEdges.site1[edge] == site ? allEdges.next1[edge] : allEdges.next2[edge];
+	}
+
+	// the caller moved site i to newIndices[i], keep the sort order in step
+	void renumberSites(const std::vector<int> &newIndices)
+	{
+		for(size_t i = 0; i < sortOrder.size(); i++)
+			sortOrder[i] = newIndices[sortOrder[i]];
+	}
+
+
+private:
+	void cleanup();
+	void cleanupEdges();
+	void resetArena();
+	void sortSites(bool nearlySorted);
+	bool insertionSortSites(long limit);
+	void radixSortSites();
+	template<class T> int getfree(std::vector<T> &pool, struct Freelist *fl, int T::*next);
+	template<class T> void makefree(std::vector<T> &pool, struct Freelist *fl, int T::*next, int curr);
+	int PQempty();
+
+	int *ELhash;
+	int HEcreate(int e,int pm);
+
+	struct Point PQ_min();
+	int PQextractmin();	
+	void freeinit(struct Freelist *fl);
+	void geominit();
+	void plotinit();
+	bool voronoi(int triangulate);
+	void ref(int v);
+	void deref(int v);
+	void endpoint(int e,int lr,int s);
+
+	void ELdelete(int he);
+	int ELleftbnd(struct Point *p);
+	int ELright(int he);
+	void makevertex(int v);
+	void out_triple(int s1, int s2,int s3);
+
+	void PQinsert(int he,int v, float offset);
+	void PQdelete(int he);
+	bool ELinitialize();
+	void ELinsert(int lb, int newHe);
+	int ELgethash(int b);
+	int ELtreapleftbnd(struct Point *p);
+	void ELtreapinsert(int lb, int newHe);
+	void ELtreapdelete(int he);
+	void ELrotateup(int he);
+	bool PQless(const struct PQEntry &a, const struct PQEntry &b);
+	void PQheapup(int i);
+	void PQheapdown(int i);
+	void PQheapremove(int i);
+	int ELleft(int he);
+	int leftreg(int he);
+	void out_site(int s);
+	bool PQinitialize();
+	int PQbucket(int he);
+	void clip_line(int e);
+	char *myalloc(unsigned n);
+	int right_of(int el,struct Point *p);
+
+	int rightreg(int he);
+	int bisect(int s1,int s2);
+	float dist(int s,int t);
+	int intersect(int el1, int el2);
+
+	void out_bisector(int e);
+	void out_ep(int e);
+	void out_vertex(int v);
+	int nextone();
+
+	void pushGraphEdge(float x1, float y1, float x2, float y2, int s1, int s2);
+	void createCells();
+	float borderPosition(float x, float y);
+	bool onBorder(float x, float y, float tolerance);
+
+	void openpl();
+	void line(float x1, float y1, float x2, float y2, int s1, int s2);
+	void circle(float x, float y, float radius);
+	void range(float minX, float minY, float maxX, float maxY);
+
+
+	// the input sites come first in the site pool, and the vertices found
+	// by the sweep after them
+	std::vector<Site> sites;
+	std::vector<Edge> edges;
+	std::vector<Halfedge> halfedges;
+	std::vector<TreapNode> ELtreap;
+	long poolAlloc;
+
+	struct  Freelist	hfl;
+	int		ELleftend, ELrightend;
+	int 	ELhashsize;
+
+	int		triangulate, sorted, plot, debug;
+	float	xmin, xmax, ymin, ymax, deltax, deltay;
+
+	int		nsites;
+	int		siteidx;
+	int		sqrt_nsites;
+	int		nvertices;
+	struct 	Freelist sfl;
+	int		bottomsite;
+
+	int		nedges;
+	struct	Freelist efl;
+	int		PQhashsize;
+	int		*PQhash;
+	int		PQcount;
+	int		PQmin;
+
+	BeachLine beachLine;
+	EventQueue eventQueue;
+	int		ELroot;
+	unsigned int ELseed;
+	std::vector<PQEntry> PQheap;
+
+	int		ntry, totalsearch;
+	float	pxmin, pxmax, pymin, pymax, cradius;
+	int		total_alloc;
+
+	float borderMinX, borderMaxX, borderMinY, borderMaxY;
+
+	FreeNodeArrayList* allMemoryList;
+	FreeNodeArrayList* currentMemoryBlock;
+
+	// everything a diagram needs is carved out of one block which is kept
+	// from one diagram to the next, and grown to fit the last diagram
+	char *arena;
+	int arenaSize, arenaUsed;
+
+	GraphEdges allEdges;
+	GraphCells allCells;
+	bool closedCells;
+
+	// a site's cell is complete once the last of its arcs leaves the beach
+	// line, so the callback is made when the count of them drops to zero
+	CellCallback cellCallback;
+	void *cellContext;
+	std::vector<int> arcCounts, cellFirstEdge, cellLastEdge;
+	struct CellSide
+	{
+		float x1, y1, x2, y2, angle;
+		int neighbour;
+	};
+
+	std::vector<int> cellEdgeOffsets, cellEdgeList, cellEdgeFill;
+	std::vector<CellSide> cellSides;
+	int iteratorEdges;
+	std::vector<Point> sitePoints;
+
+	struct RadixKey
+	{
+		unsigned long long key;
+		int index;
+	};
+
+	// the input index of every site, in the sorted order of the last diagram
+	std::vector<int> sortOrder;
+	std::vector<RadixKey> radixKeys, radixBuffer;
+	std::vector<Site> siteBuffer;
+	float sortTime;
+
+	float minDistanceBetweenSites;
+	
+};
+
+int scomp(const void *p1,const void *p2);
+
+
+#endif
+
+
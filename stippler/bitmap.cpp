@@ -1,98 +1,194 @@
-/* The MIT License
-
-Copyright (c) 2011 Sahab Yazdani
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-THE SOFTWARE.
-*/
-
-#include <cstdlib>
-#include <cmath>
-
-#include "bitmap.h"
-
-Bitmap::Bitmap( std::string filename ) {
-	using std::ceil;
-
-	file = PNG::load( filename );
-
-	intensityMap = new unsigned char[file->w * file->h];
-	unsigned char *imPtr = intensityMap, *cPtr = file->data;
-
-	for (unsigned int y = 0; y < file->h; y++) {
-		for (unsigned int x = 0; x < file->w; x++, imPtr++, cPtr+=4) {
-			*imPtr = 255 - (unsigned char)ceil(((float)(*(cPtr)) * 0.2126 + (float)(*(cPtr+1)) * 0.7152 + (float)(*(cPtr+2)) * 0.0722));
-		}
-	}
-}
-
-Bitmap::~Bitmap() {
-	PNG::freePng( file );
-	delete[] intensityMap;
-}
-
-float Bitmap::getIntensity( float x, float y ) {
-	using std::floor;
-
-	// from wikipedia 
-	unsigned char *iMPtr = intensityMap + (unsigned int)floor(y) * file->w + (unsigned int)floor(x);
-	float fX = x - floor(x), fY = y - floor(y);
-	
-	return 
-		(float)(*(iMPtr)) * (1 - fX) * (1 - fY) + 
-		(float)(*(iMPtr + 1)) * fX * (1 - fY) +
-		(float)(*(iMPtr + file->w)) * (1 - fX) * fY +
-		(float)(*(iMPtr + file->w + 1)) * fX * fY;
-}
-
-void Bitmap::getColour( float x, float y, unsigned char &r, unsigned char &g, unsigned char &b ) {
-	using std::floor;
-
-	float fX = x - floor(x), fY = y - floor(y);
-	float f00 = (1 - fX) * (1 - fY),
-		f10 = fX * (1 - fY),
-		f01 = (1 - fX) * fY,
-		f11 = fX * fY;
-
-	unsigned char *dataPtr = file->data + (((unsigned int)floor(y) * file->w + (unsigned int)floor(x)) * 4);
-	r = (unsigned char)floor((float)(*(dataPtr)) * f00 + 
-		(float)(*(dataPtr + 4)) * f10 +
-		(float)(*(dataPtr + file->w * 4)) * f01 +
-		(float)(*(dataPtr + file->w * 4 + 4)) * f11);
-
-	dataPtr++;
-	g = (unsigned char)floor((float)(*(dataPtr)) * f00 + 
-		(float)(*(dataPtr + 4)) * f10 +
-		(float)(*(dataPtr + file->w * 4)) * f01 +
-		(float)(*(dataPtr + file->w * 4 + 4)) * f11);
-
-	dataPtr++;
-	b = (unsigned char)floor((float)(*(dataPtr)) * f00 + 
-		(float)(*(dataPtr + 4)) * f10 +
-		(float)(*(dataPtr + file->w * 4)) * f01 +
-		(float)(*(dataPtr + file->w * 4 + 4)) * f11);
-}
-
-unsigned int Bitmap::getWidth() {
-	return file->w;
-}
-
-unsigned int Bitmap::getHeight() {
-	return file->h;
-}
-
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <cstdlib>
+#include <cmath>
+
+#include "bitmap.h"
+
+Bitmap::Bitmap( std::string filename )
+: massIntegral(NULL), momentIntegral(NULL),
+supersampled(NULL), supersampledWidth(0), supersampledHeight(0), supersampledDensity(0) {
+	using std::ceil;
+
+	file = PNG::load( filename );
+
+	// the sampling kernels read pixels four bytes at a time, so the last one
+	// is padded out
+	intensityMap = new unsigned char[file->w * file->h + 3];
+	unsigned char *imPtr = intensityMap, *cPtr = file->data;
+
+	for (unsigned int y = 0; y < file->h; y++) {
+		for (unsigned int x = 0; x < file->w; x++, imPtr++, cPtr+=4) {
+			*imPtr = 255 - (unsigned char)ceil(((float)(*(cPtr)) * 0.2126 + (float)(*(cPtr+1)) * 0.7152 + (float)(*(cPtr+2)) * 0.0722));
+		}
+	}
+}
+
+Bitmap::~Bitmap() {
+	PNG::freePng( file );
+	delete[] intensityMap;
+	delete[] massIntegral;
+	delete[] momentIntegral;
+	delete[] supersampled;
+}
+
+const unsigned char *Bitmap::getIntensityMap() {
+	return intensityMap;
+}
+
+unsigned int Bitmap::createSupersampledIntensities( unsigned int density, size_t budget, IntensitySampleFunction sample ) {
+	delete[] supersampled;
+	supersampled = NULL;
+
+	// one sample at the centre of every subpixel, at the highest density
+	// which fits the budget
+	for ( ; density > 0; density-- ) {
+		size_t samples = (size_t)( file->w - 1 ) * density * ( file->h - 1 ) * density;
+
+		if ( samples * sizeof( float ) <= budget ) {
+			break;
+		}
+	}
+
+	supersampledDensity = density;
+	supersampledWidth = ( file->w - 1 ) * density;
+	supersampledHeight = ( file->h - 1 ) * density;
+
+	if ( density == 0 ) {
+		return 0;
+	}
+
+	supersampled = new float[(size_t)supersampledWidth * supersampledHeight];
+
+	#pragma omp parallel for
+	for ( int y = 0; y < (int)supersampledHeight; y++ ) {
+		float *sPtr = supersampled + (size_t)y * supersampledWidth;
+
+		for ( unsigned int x = 0; x < supersampledWidth; x++ ) {
+			sPtr[x] = sample( intensityMap, file->w, ( x + 0.5f ) / density, ( y + 0.5f ) / density );
+		}
+	}
+
+	return density;
+}
+
+const float *Bitmap::getSupersampledIntensities() {
+	return supersampled;
+}
+
+unsigned int Bitmap::getSupersampledWidth() {
+	return supersampledWidth;
+}
+
+unsigned int Bitmap::getSupersampledHeight() {
+	return supersampledHeight;
+}
+
+unsigned int Bitmap::getSupersampledDensity() {
+	return supersampledDensity;
+}
+
+void Bitmap::createRowIntegrals() {
+	if ( massIntegral != NULL ) {
+		return;
+	}
+
+	massIntegral = new double[file->w * file->h];
+	momentIntegral = new double[file->w * file->h];
+
+	for (unsigned int y = 0; y < file->h; y++) {
+		unsigned char *iMPtr = intensityMap + y * file->w;
+		double *mPtr = massIntegral + y * file->w, *tPtr = momentIntegral + y * file->w;
+
+		mPtr[0] = tPtr[0] = 0.0;
+		for (unsigned int x = 0; x + 1 < file->w; x++) {
+			// the intensity between two pixels is a + b * t for t in [0, 1)
+			double a = (double)iMPtr[x], b = (double)iMPtr[x + 1] - a;
+
+			mPtr[x + 1] = mPtr[x] + a + b / 2.0;
+			tPtr[x + 1] = tPtr[x] + x * a + (x * b + a) / 2.0 + b / 3.0;
+		}
+	}
+}
+
+void Bitmap::getRowIntegrals( float x, float y, double &mass, double &moment ) {
+	using std::floor;
+
+	// clamp to the last pixel span so that the right and bottom edges of the
+	// image do not read outside of the tables
+	unsigned int iX = (unsigned int)floor(x), iY = (unsigned int)floor(y);
+	if ( iX + 1 >= file->w ) iX = file->w - 2;
+	if ( iY + 1 >= file->h ) iY = file->h - 2;
+
+	double fX = x - iX, fY = y - iY;
+	double m[2], t[2];
+
+	for (unsigned int row = 0; row < 2; row++) {
+		unsigned int offset = (iY + row) * file->w + iX;
+		double a = (double)intensityMap[offset], b = (double)intensityMap[offset + 1] - a;
+
+		m[row] = massIntegral[offset] + a * fX + b * fX * fX / 2.0;
+		t[row] = momentIntegral[offset] + iX * a * fX + (iX * b + a) * fX * fX / 2.0 + b * fX * fX * fX / 3.0;
+	}
+
+	mass = m[0] * (1 - fY) + m[1] * fY;
+	moment = t[0] * (1 - fY) + t[1] * fY;
+}
+
+void Bitmap::getColour( float x, float y, unsigned char &r, unsigned char &g, unsigned char &b ) {
+	using std::floor;
+
+	float fX = x - floor(x), fY = y - floor(y);
+	float f00 = (1 - fX) * (1 - fY),
+		f10 = fX * (1 - fY),
+		f01 = (1 - fX) * fY,
+		f11 = fX * fY;
+
+	unsigned char *dataPtr = file->data + (((unsigned int)floor(y) * file->w + (unsigned int)floor(x)) * 4);
+	r = (unsigned char)floor((float)(*(dataPtr)) * f00 + 
+		(float)(*(dataPtr + 4)) * f10 +
+		(float)(*(dataPtr + file->w * 4)) * f01 +
+		(float)(*(dataPtr + file->w * 4 + 4)) * f11);
+
+	dataPtr++;
+	g = (unsigned char)floor((float)(*(dataPtr)) * f00 + 
+		(float)(*(dataPtr + 4)) * f10 +
+		(float)(*(dataPtr + file->w * 4)) * f01 +
+		(float)(*(dataPtr + file->w * 4 + 4)) * f11);
+
+	dataPtr++;
+	b = (unsigned char)floor((float)(*(dataPtr)) * f00 + 
+		(float)(*(dataPtr + 4)) * f10 +
+		(float)(*(dataPtr + file->w * 4)) * f01 +
+		(float)(*(dataPtr + file->w * 4 + 4)) * f11);
+}
+
+unsigned int Bitmap::getWidth() {
+	return file->w;
+}
+
+unsigned int Bitmap::getHeight() {
+	return file->h;
+}
+
@@ -1,52 +1,124 @@
-/* The MIT License
-
-Copyright (c) 2011 Sahab Yazdani
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-THE SOFTWARE.
-*/
-
-#ifndef BITMAP_H
-#define BITMAP_H
-
-#ifdef _WIN32
-#define NOMINMAX
-#include <windows.h>
-#endif // _WIN32
-
-#include <string>
-
-#include <picopng.h>
-
-class Bitmap {
-public:
-	Bitmap( std::string filename );
-	~Bitmap();
-
-	float getIntensity( float x, float y );
-
-	void getColour( float x, float y, unsigned char &r, unsigned char &g, unsigned char &b );
-
-	unsigned int getWidth();
-	unsigned int getHeight();
-private:
-	PNG::PNGFile *file;
-	unsigned char *intensityMap;
-};
-
-#endif // BITMAP_H
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif // _WIN32
+
+#include <cstddef>
+#include <cmath>
+#include <string>
+
+#include <picopng.h>
+
+// the ways the intensity between pixels is read from a width wide map, for
+// the sampling loops to be templated on. (x, y) has to lie in the image.
+typedef float (*IntensitySampleFunction)( const unsigned char *map, unsigned int width, float x, float y );
+
+// the intensity of the nearest pixel
+struct NearestSampler {
+	static float sample( const unsigned char *map, unsigned int width, float x, float y ) {
+		return (float)map[(unsigned int)( y + 0.5f ) * width + (unsigned int)( x + 0.5f )];
+	}
+};
+
+// the intensity interpolated between the four pixels around (x, y)
+struct BilinearSampler {
+	static float sample( const unsigned char *map, unsigned int width, float x, float y ) {
+		using std::floor;
+
+		// from wikipedia 
+		const unsigned char *iMPtr = map + (unsigned int)floor(y) * width + (unsigned int)floor(x);
+		float fX = x - floor(x), fY = y - floor(y);
+		
+		return 
+			(float)(*(iMPtr)) * (1 - fX) * (1 - fY) + 
+			(float)(*(iMPtr + 1)) * fX * (1 - fY) +
+			(float)(*(iMPtr + width)) * (1 - fX) * fY +
+			(float)(*(iMPtr + width + 1)) * fX * fY;
+	}
+};
+
+// the mean of the four pixels around (x, y), a box filter one pixel wide
+struct BoxSampler {
+	static float sample( const unsigned char *map, unsigned int width, float x, float y ) {
+		const unsigned char *iMPtr = map + (unsigned int)y * width + (unsigned int)x;
+
+		return (float)( iMPtr[0] + iMPtr[1] + iMPtr[width] + iMPtr[width + 1] ) * 0.25f;
+	}
+};
+
+class Bitmap {
+public:
+	Bitmap( std::string filename );
+	~Bitmap();
+
+	template< class Sampler > float sample( float x, float y ) {
+		return Sampler::sample( intensityMap, file->w, x, y );
+	}
+	float getIntensity( float x, float y ) {
+		return sample< BilinearSampler >( x, y );
+	}
+	// the intensities the samplers read, row by row
+	const unsigned char *getIntensityMap();
+
+	// precomputes the intensity at the centre of every 1 / density of a
+	// pixel, lowering the density until the samples fit in budget bytes.
+	// returns the density used, 0 if not even one sample per pixel fits.
+	unsigned int createSupersampledIntensities( unsigned int density, size_t budget, IntensitySampleFunction sample );
+	// the precomputed intensity nearest to (x, y)
+	float getSupersampledIntensity( float x, float y ) {
+		unsigned int iX = (unsigned int)( x * supersampledDensity ), iY = (unsigned int)( y * supersampledDensity );
+		if ( iX >= supersampledWidth ) iX = supersampledWidth - 1;
+		if ( iY >= supersampledHeight ) iY = supersampledHeight - 1;
+
+		return supersampled[iY * supersampledWidth + iX];
+	}
+	const float *getSupersampledIntensities();
+	unsigned int getSupersampledWidth();
+	unsigned int getSupersampledHeight();
+	unsigned int getSupersampledDensity();
+
+	// builds the row prefix sums used by getRowIntegrals
+	void createRowIntegrals();
+	// integrates the (bilinear) intensity, and x times the intensity, along
+	// row y from 0 to x. createRowIntegrals must have been called.
+	void getRowIntegrals( float x, float y, double &mass, double &moment );
+
+	void getColour( float x, float y, unsigned char &r, unsigned char &g, unsigned char &b );
+
+	unsigned int getWidth();
+	unsigned int getHeight();
+private:
+	PNG::PNGFile *file;
+	unsigned char *intensityMap;
+	double *massIntegral, *momentIntegral;
+	float *supersampled;
+	unsigned int supersampledWidth, supersampledHeight, supersampledDensity;
+};
+
+#endif // BITMAP_H
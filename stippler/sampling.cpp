@@ -0,0 +1,269 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "sampling.h"
+
+// the vector kernels are compiled for their instruction sets function by
+// function, so the rest of the program still runs on any x86 processor
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define SAMPLING_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#ifdef SAMPLING_X86_KERNELS
+
+namespace {
+	// each kernel keeps the lanes inside every clip line, evaluated in the
+	// same order as the scalar loop so samples on an edge fall the same way,
+	// and interpolates the intensity at them the way the samplers in
+	// bitmap.h do, reading both horizontal neighbours at once. nearest and
+	// box sampling are bilinear interpolation with the weight of the far
+	// pixel snapped to 0 or 1, or held at a half
+
+	inline float sampleWeight( IntensitySampler sampler, float f ) {
+		switch ( sampler ) {
+		case SAMPLER_NEAREST: return f >= 0.5f ? 1.0f : 0.0f;
+		case SAMPLER_BOX: return 0.5f;
+		default: return f;
+		}
+	}
+
+	__attribute__((target("sse2")))
+	void sampleRowSSE2( const SampleRow &row, Moments<float> &moments ) {
+		int iY = (int)row.y;
+		float fY = sampleWeight( row.sampler, row.y - (float)iY );
+		const unsigned char *rowPixels = row.intensities + iY * row.width;
+
+		__m128 step = _mm_set1_ps( row.step * 4.0f );
+		__m128 x = _mm_add_ps( _mm_set1_ps( row.x ), _mm_mul_ps( _mm_set1_ps( row.step ), _mm_set_ps( 3.0f, 2.0f, 1.0f, 0.0f ) ) );
+		__m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1.0f ), half = _mm_set1_ps( 0.5f ), y1 = _mm_set1_ps( fY ), y0 = _mm_set1_ps( 1.0f - fY );
+		__m128 area = zero, xSum = zero;
+		int inside = 0;
+
+		for ( int k = 0; k < row.count; k += 4, x = _mm_add_ps( x, step ) ) {
+			__m128 mask = _mm_castsi128_ps( _mm_cmplt_epi32( _mm_set_epi32( 3, 2, 1, 0 ), _mm_set1_epi32( row.count - k ) ) );
+
+			for ( size_t l = 0; l < row.clipLineCount; l++ ) {
+				const Line<float> &line = row.clipLines[l];
+				__m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( line.a ) ), _mm_set1_ps( row.y * line.b ) ), _mm_set1_ps( line.c ) );
+				mask = _mm_and_ps( mask, _mm_cmplt_ps( d, zero ) );
+			}
+
+			int bits = _mm_movemask_ps( mask );
+			if ( bits == 0 ) {
+				continue;
+			}
+
+			__m128i iX = _mm_cvttps_epi32( x );
+			__m128 fX = _mm_sub_ps( x, _mm_cvtepi32_ps( iX ) );
+			if ( row.sampler == SAMPLER_NEAREST ) {
+				fX = _mm_and_ps( _mm_cmpge_ps( fX, half ), one );
+			} else if ( row.sampler == SAMPLER_BOX ) {
+				fX = half;
+			}
+			int offsets[4], top[4], bottom[4];
+			_mm_storeu_si128( (__m128i *)offsets, iX );
+
+			for ( int lane = 0; lane < 4; lane++ ) {
+				const unsigned char *p = rowPixels + ( bits >> lane & 1 ? offsets[lane] : 0 );
+				top[lane] = p[0] | p[1] << 16;
+				bottom[lane] = p[row.width] | p[row.width + 1] << 16;
+			}
+
+			__m128i lowMask = _mm_set1_epi32( 0xffff );
+			__m128i t = _mm_loadu_si128( (const __m128i *)top ), b = _mm_loadu_si128( (const __m128i *)bottom );
+			__m128 x0 = _mm_sub_ps( one, fX );
+			__m128 value = _mm_add_ps(
+				_mm_mul_ps( y0, _mm_add_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_and_si128( t, lowMask ) ), x0 ), _mm_mul_ps( _mm_cvtepi32_ps( _mm_srli_epi32( t, 16 ) ), fX ) ) ),
+				_mm_mul_ps( y1, _mm_add_ps( _mm_mul_ps( _mm_cvtepi32_ps( _mm_and_si128( b, lowMask ) ), x0 ), _mm_mul_ps( _mm_cvtepi32_ps( _mm_srli_epi32( b, 16 ) ), fX ) ) ) );
+			value = _mm_and_ps( value, mask );
+
+			area = _mm_add_ps( area, value );
+			xSum = _mm_add_ps( xSum, _mm_mul_ps( value, x ) );
+			inside += __builtin_popcount( bits );
+		}
+
+		float a[4], s[4];
+		_mm_storeu_ps( a, area );
+		_mm_storeu_ps( s, xSum );
+
+		float rowArea = ( a[0] + a[1] ) + ( a[2] + a[3] );
+		moments.areaDensity += rowArea;
+		moments.maxAreaDensity += 255.0f * inside;
+		moments.xSum += ( s[0] + s[1] ) + ( s[2] + s[3] );
+		moments.ySum += rowArea * row.y;
+	}
+
+	__attribute__((target("avx2")))
+	void sampleRowAVX2( const SampleRow &row, Moments<float> &moments ) {
+		int iY = (int)row.y;
+		float fY = sampleWeight( row.sampler, row.y - (float)iY );
+		const int *top = (const int *)( row.intensities + iY * row.width );
+		const int *bottom = (const int *)( row.intensities + ( iY + 1 ) * row.width );
+
+		__m256 step = _mm256_set1_ps( row.step * 8.0f );
+		__m256 x = _mm256_add_ps( _mm256_set1_ps( row.x ), _mm256_mul_ps( _mm256_set1_ps( row.step ), _mm256_set_ps( 7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f ) ) );
+		__m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps( 1.0f ), half = _mm256_set1_ps( 0.5f ), y1 = _mm256_set1_ps( fY ), y0 = _mm256_set1_ps( 1.0f - fY );
+		__m256i lanes = _mm256_set_epi32( 7, 6, 5, 4, 3, 2, 1, 0 ), byteMask = _mm256_set1_epi32( 0xff );
+		__m256 area = zero, xSum = zero;
+		int inside = 0;
+
+		for ( int k = 0; k < row.count; k += 8, x = _mm256_add_ps( x, step ) ) {
+			__m256 mask = _mm256_castsi256_ps( _mm256_cmpgt_epi32( _mm256_set1_epi32( row.count - k ), lanes ) );
+
+			for ( size_t l = 0; l < row.clipLineCount; l++ ) {
+				const Line<float> &line = row.clipLines[l];
+				__m256 d = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( x, _mm256_set1_ps( line.a ) ), _mm256_set1_ps( row.y * line.b ) ), _mm256_set1_ps( line.c ) );
+				mask = _mm256_and_ps( mask, _mm256_cmp_ps( d, zero, _CMP_LT_OQ ) );
+			}
+
+			int bits = _mm256_movemask_ps( mask );
+			if ( bits == 0 ) {
+				continue;
+			}
+
+			// the lanes outside the cell read the first pixel of the row
+			__m256i iX = _mm256_and_si256( _mm256_cvttps_epi32( x ), _mm256_castps_si256( mask ) );
+			__m256 fX = _mm256_sub_ps( x, _mm256_cvtepi32_ps( _mm256_cvttps_epi32( x ) ) );
+			if ( row.sampler == SAMPLER_NEAREST ) {
+				fX = _mm256_and_ps( _mm256_cmp_ps( fX, half, _CMP_GE_OQ ), one );
+			} else if ( row.sampler == SAMPLER_BOX ) {
+				fX = half;
+			}
+			__m256i t = _mm256_i32gather_epi32( top, iX, 1 ), b = _mm256_i32gather_epi32( bottom, iX, 1 );
+			__m256 x0 = _mm256_sub_ps( one, fX );
+			__m256 value = _mm256_add_ps(
+				_mm256_mul_ps( y0, _mm256_add_ps(
+					_mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_and_si256( t, byteMask ) ), x0 ),
+					_mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_and_si256( _mm256_srli_epi32( t, 8 ), byteMask ) ), fX ) ) ),
+				_mm256_mul_ps( y1, _mm256_add_ps(
+					_mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_and_si256( b, byteMask ) ), x0 ),
+					_mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_and_si256( _mm256_srli_epi32( b, 8 ), byteMask ) ), fX ) ) ) );
+			value = _mm256_and_ps( value, mask );
+
+			area = _mm256_add_ps( area, value );
+			xSum = _mm256_add_ps( xSum, _mm256_mul_ps( value, x ) );
+			inside += __builtin_popcount( bits );
+		}
+
+		__m128 a = _mm_add_ps( _mm256_castps256_ps128( area ), _mm256_extractf128_ps( area, 1 ) );
+		__m128 s = _mm_add_ps( _mm256_castps256_ps128( xSum ), _mm256_extractf128_ps( xSum, 1 ) );
+		a = _mm_hadd_ps( a, s );
+		a = _mm_hadd_ps( a, a );
+
+		float rowArea = _mm_cvtss_f32( a );
+		moments.areaDensity += rowArea;
+		moments.maxAreaDensity += 255.0f * inside;
+		moments.xSum += _mm_cvtss_f32( _mm_shuffle_ps( a, a, 1 ) );
+		moments.ySum += rowArea * row.y;
+	}
+
+	// the AVX-512 headers of GCC 12 initialise their undefined vectors with
+	// themselves, which trips its own uninitialised warnings
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+	__attribute__((target("avx512f")))
+	void sampleRowAVX512( const SampleRow &row, Moments<float> &moments ) {
+		int iY = (int)row.y;
+		float fY = sampleWeight( row.sampler, row.y - (float)iY );
+		const int *top = (const int *)( row.intensities + iY * row.width );
+		const int *bottom = (const int *)( row.intensities + ( iY + 1 ) * row.width );
+
+		__m512 step = _mm512_set1_ps( row.step * 16.0f );
+		__m512 x = _mm512_add_ps( _mm512_set1_ps( row.x ), _mm512_mul_ps( _mm512_set1_ps( row.step ),
+			_mm512_set_ps( 15.0f, 14.0f, 13.0f, 12.0f, 11.0f, 10.0f, 9.0f, 8.0f, 7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f ) ) );
+		__m512 zero = _mm512_setzero_ps(), one = _mm512_set1_ps( 1.0f ), half = _mm512_set1_ps( 0.5f ), y1 = _mm512_set1_ps( fY ), y0 = _mm512_set1_ps( 1.0f - fY );
+		__m512i byteMask = _mm512_set1_epi32( 0xff );
+		__m512 area = zero, xSum = zero;
+		int inside = 0;
+
+		for ( int k = 0; k < row.count; k += 16, x = _mm512_add_ps( x, step ) ) {
+			__mmask16 mask = row.count - k >= 16 ? (__mmask16)0xffff : (__mmask16)( ( 1u << ( row.count - k ) ) - 1 );
+
+			for ( size_t l = 0; l < row.clipLineCount && mask; l++ ) {
+				const Line<float> &line = row.clipLines[l];
+				__m512 d = _mm512_add_ps( _mm512_add_ps( _mm512_mul_ps( x, _mm512_set1_ps( line.a ) ), _mm512_set1_ps( row.y * line.b ) ), _mm512_set1_ps( line.c ) );
+				mask = _mm512_mask_cmp_ps_mask( mask, d, zero, _CMP_LT_OQ );
+			}
+
+			if ( mask == 0 ) {
+				continue;
+			}
+
+			// masked gathers leave the lanes outside the cell unread
+			__m512i iX = _mm512_cvttps_epi32( x );
+			__m512 fX = _mm512_sub_ps( x, _mm512_cvtepi32_ps( iX ) );
+			if ( row.sampler == SAMPLER_NEAREST ) {
+				fX = _mm512_maskz_mov_ps( _mm512_cmp_ps_mask( fX, half, _CMP_GE_OQ ), one );
+			} else if ( row.sampler == SAMPLER_BOX ) {
+				fX = half;
+			}
+			__m512i t = _mm512_mask_i32gather_epi32( _mm512_setzero_si512(), mask, iX, top, 1 );
+			__m512i b = _mm512_mask_i32gather_epi32( _mm512_setzero_si512(), mask, iX, bottom, 1 );
+			__m512 x0 = _mm512_sub_ps( one, fX );
+			__m512 value = _mm512_add_ps(
+				_mm512_mul_ps( y0, _mm512_add_ps(
+					_mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_and_si512( t, byteMask ) ), x0 ),
+					_mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_and_si512( _mm512_srli_epi32( t, 8 ), byteMask ) ), fX ) ) ),
+				_mm512_mul_ps( y1, _mm512_add_ps(
+					_mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_and_si512( b, byteMask ) ), x0 ),
+					_mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_and_si512( _mm512_srli_epi32( b, 8 ), byteMask ) ), fX ) ) ) );
+
+			area = _mm512_mask_add_ps( area, mask, area, value );
+			xSum = _mm512_mask_add_ps( xSum, mask, xSum, _mm512_mul_ps( value, x ) );
+			inside += __builtin_popcount( mask );
+		}
+
+		float rowArea = _mm512_reduce_add_ps( area );
+		moments.areaDensity += rowArea;
+		moments.maxAreaDensity += 255.0f * inside;
+		moments.xSum += _mm512_reduce_add_ps( xSum );
+		moments.ySum += rowArea * row.y;
+	}
+
+#pragma GCC diagnostic pop
+}
+
+SampleRowKernel selectSampleRowKernel() {
+	__builtin_cpu_init();
+
+	if ( __builtin_cpu_supports( "avx512f" ) ) {
+		return sampleRowAVX512;
+	} else if ( __builtin_cpu_supports( "avx2" ) ) {
+		return sampleRowAVX2;
+	} else if ( __builtin_cpu_supports( "sse2" ) ) {
+		return sampleRowSSE2;
+	}
+
+	return NULL;
+}
+
+#else
+
+SampleRowKernel selectSampleRowKernel() {
+	return NULL;
+}
+
+#endif // SAMPLING_X86_KERNELS
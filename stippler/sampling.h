@@ -0,0 +1,53 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <cstddef>
+
+#include "stippler.h"
+#include "utility.h"
+
+// a row of subsamples of a cell: count samples, step apart from (x, y),
+// which count where they are on the inside of every clip line, read the
+// way sampler does
+struct SampleRow {
+	const unsigned char *intensities;
+	unsigned int width;
+	const Line<float> *clipLines;
+	size_t clipLineCount;
+	float x;
+	float y;
+	float step;
+	int count;
+	IntensitySampler sampler;
+};
+
+// adds the intensity moments of the samples of a row inside the cell
+typedef void (*SampleRowKernel)( const SampleRow &row, Moments<float> &moments );
+
+// the widest vector kernel the processor supports, or NULL if it has none
+SampleRowKernel selectSampleRowKernel();
+
+#endif // SAMPLING_H
@@ -1,339 +1,1967 @@
-/* The MIT License
-
-Copyright (c) 2011 Sahab Yazdani
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-THE SOFTWARE.
-*/
-
-#include "stippler_impl.h"
-
-#include <fstream>
-#include <limits>
-#include <cstring>
-
-#include <boost/random.hpp>
-
-#include "VoronoiDiagramGenerator.h"
-
-Stippler::Stippler( const StipplingParameters &parameters )
-: IStippler(),
-vertsX(new float[parameters.points]), vertsY(new float[parameters.points]), radii(new float[parameters.points]),
-displacement(std::numeric_limits<float>::max()),
-image(parameters.inputFile),
-parameters(parameters) {
-	createInitialDistribution();
-}
-
-Stippler::~Stippler() {
-	delete[] radii;
-	delete[] vertsX;
-	delete[] vertsY;
-}
-
-void Stippler::distribute() {
-	createVoronoiDiagram();
-	redistributeStipples();
-}
-
-float Stippler::getAverageDisplacement() {
-	return displacement;
-}
-
-void Stippler::createInitialDistribution() {
-	using std::ceil;
-
-	// find initial distribution
-	boost::mt19937 rng;
-	boost::uniform_01<boost::mt19937, float> generator( rng );
-
-	float w = (float)(image.getWidth() - 1), h = (float)(image.getHeight() - 1);
-	float xC, yC;
-
-	for ( unsigned int i = 0; i < parameters.points; ) {
-		xC = generator() * w;
-		yC = generator() * h;
-
-		// do a nearest neighbour search on the vertices
-		if ( ceil(generator() * 255.0f) <= image.getIntensity( xC, yC ) ) {
-			vertsX[i] = xC;
-			vertsY[i] = yC;
-			radii[i] = 0.0f;
-
-			i++;
-		}
-	}
-}
-
-void Stippler::getStipples( StipplePoint *dst ) {
-	StipplePoint *workingPtr;
-
-	for (unsigned int i = 0; i < parameters.points; i++ ) {
-		workingPtr = &(dst[i]);
-
-		workingPtr->x = vertsX[i];
-		workingPtr->y = vertsY[i];
-		workingPtr->radius = radii[i];
-
-		image.getColour(vertsX[i], vertsY[i], workingPtr->r, workingPtr->g, workingPtr->b); 
-	}
-}
-
-void Stippler::createVoronoiDiagram() {
-	VoronoiDiagramGenerator generator;
-
-	generator.generateVoronoi( vertsX, vertsY, parameters.points, 
-		0.0f, (float)(image.getWidth() - 1), 0.0f, (float)(image.getHeight() - 1) );
-
-	edges.clear();
-
-	Point< float > p1, p2;
-	Edge< float > edge;
-
-	generator.resetIterator();
-	while ( generator.getNext( 
-		edge.begin.x, edge.begin.y, edge.end.x, edge.end.y,
-		p1.x, p1.y, p2.x, p2.y ) ) {
-
-		if ( edge.begin == edge.end ) {
-			continue;
-		}
-
-		if ( edges.find( p1 ) == edges.end() ) {
-			edges[p1] = EdgeList();
-		}
-		if ( edges.find( p2 ) == edges.end() ) {
-			edges[p2] = EdgeList();
-		}
-		edges[p1].push_back( edge );
-		edges[p2].push_back( edge );
-	}
-}
-
-void Stippler::redistributeStipples() {
-	using std::pow;
-	using std::sqrt;
-	using std::pair;
-	using std::make_pair;
-	using std::vector;
-
-	vector< pair< Point< float >, EdgeList > > vectorized;
-	for ( EdgeMap::iterator key_iter = edges.begin(); key_iter != edges.end(); ++key_iter ) {
-		vectorized.push_back(make_pair(key_iter->first, key_iter->second));
-	}
-
-	float local_displacement = 0.0f;
-
-	#pragma omp parallel for reduction(+:local_displacement)
-	for (int i = 0; i < (int)vectorized.size(); i++) {
-		pair< Point< float >, EdgeList > item = vectorized[i];
-		pair< Point<float>, float > centroid = calculateCellCentroid( item.first, item.second );
-
-		radii[i] = centroid.second;
-		vertsX[i] = centroid.first.x;
-		vertsY[i] = centroid.first.y;
-
-		local_displacement += sqrt( pow( item.first.x - centroid.first.x, 2.0f ) + pow( item.first.y - centroid.first.y, 2.0f ) );
-	}
-
-	displacement = local_displacement / vectorized.size(); // average out the displacement
-}
-
-inline Line<float> Stippler::createClipLine( float insideX, float insideY, float x1, float y1, float x2, float y2 ) {
-	using std::abs;
-	using std::numeric_limits;
-
-	Line<float> l;
-
-	// if the floating point version of the line collapsed down to one
-	// point, then just ignore it all
-	if (abs(x1 - x2) < numeric_limits<float>::epsilon() && abs(y1 - y2) < numeric_limits<float>::epsilon()) {
-		l.a = .0f;
-		l.b = .0f;
-		l.c = .0f;
-
-		return l;
-	}
-
-	l.a = -(y1 - y2);
-	l.b = x1 - x2;
-	l.c = (y1 - y2) * x1 - (x1 - x2) * y1;
-
-	// make sure the known inside point falls on the correct side of the clipping plane
-	if ( insideX * l.a + insideY * l.b + l.c > 0.0f ) {
-		l.a *= -1;
-		l.b *= -1;
-		l.c *= -1;
-	}
-
-	return l;
-}
-
-std::pair< Point<float>, float > Stippler::calculateCellCentroid( Point<float> &inside, EdgeList &edgeList ) {
-	using std::make_pair;
-	using std::numeric_limits;
-	using std::vector;
-	using std::floor;
-	using std::ceil;
-	using std::abs;
-	using std::sqrt;
-	using std::pow;
-
-	vector< Line<float> > clipLines;
-	Extents<float> extent = getCellExtents(edgeList);
-
-	unsigned int x, y;
-
-	float xDiff = ( extent.maxX - extent.minX );
-	float yDiff = ( extent.maxY - extent.minY );
-
-	unsigned int tileWidth = (unsigned int)ceil(xDiff) * parameters.subpixels;
-	unsigned int tileHeight = (unsigned int)ceil(yDiff) * parameters.subpixels;
-
-	float xStep = xDiff / (float)tileWidth;
-	float yStep = yDiff / (float)tileHeight;
-
-	float spotDensity, areaDensity = 0.0f, maxAreaDensity = 0.0f;
-	float xSum = 0.0f;
-	float ySum = 0.0f;
-
-	float xCurrent;
-	float yCurrent;
-
-	// compute the clip lines
-	for ( EdgeList::iterator value_iter = edgeList.begin(); value_iter != edgeList.end(); ++value_iter ) {
-		Line<float> l = createClipLine( inside.x, inside.y, 
-			value_iter->begin.x, value_iter->begin.y,
-			value_iter->end.x, value_iter->end.y );
-	
-		if (l.a < numeric_limits<float>::epsilon() && abs(l.b) < numeric_limits<float>::epsilon()) {
-			continue;
-		}
-
-		clipLines.push_back(l);
-	}
-
-	for ( y = 0, yCurrent = extent.minY; y < tileHeight; ++y, yCurrent += yStep ) {
-		for ( x = 0, xCurrent = extent.minX; x < tileWidth; ++x, xCurrent += xStep ) {
-			// a point is outside of the polygon if it is outside of all clipping planes
-			bool outside = false;
-			for ( vector< Line<float> >::iterator iter = clipLines.begin(); iter != clipLines.end(); iter++ ) {
-				if ( xCurrent * iter->a + yCurrent * iter->b + iter->c >= 0.0f ) {
-					outside = true;
-					break;
-				}
-			}
-
-			if (!outside) {
-				spotDensity = image.getIntensity(xCurrent, yCurrent);
-
-				areaDensity += spotDensity;
-				maxAreaDensity += 255.0f;
-				xSum += spotDensity * xCurrent;
-				ySum += spotDensity * yCurrent;
-			}
-		}
-	}
-
-	float area = areaDensity * xStep * yStep / 255.0f;
-	float maxArea = maxAreaDensity * xStep * yStep / 255.0f;
-
-	Point<float> pt;
-	if (areaDensity > numeric_limits<float>::epsilon()) {
-		pt.x = xSum / areaDensity;
-		pt.y = ySum / areaDensity;
-	} else {
-		// if for some reason, the cell is completely white, then the centroid does not move
-		pt.x = inside.x;
-		pt.y = inside.y;
-	}
-
-	float closest = numeric_limits<float>::max(),
-		  farthest = numeric_limits<float>::min(),
-		  distance;
-	float x0 = pt.x, y0 = pt.y,
-	      x1, x2, y1, y2;
-
-	for ( EdgeList::iterator value_iter = edgeList.begin(); value_iter != edgeList.end(); ++value_iter ) {
-		x1 = value_iter->begin.x; x2 = value_iter->end.x;
-		y1 = value_iter->begin.y; y2 = value_iter->end.y;
-
-		distance = abs( ( x2 - x1 ) * ( y1 - y0 ) - ( x1 - x0 ) * ( y2 - y1 ) ) / sqrt( pow( x2 - x1, 2.0f ) + pow( y2 - y1, 2.0f ) );
-		if ( closest > distance ) {
-			closest = distance;
-		}
-		if ( farthest < distance ) {
-			farthest = distance;
-		}
-	}
-
-	float radius;
-	if ( parameters.noOverlap ) {
-		radius = closest;
-	} else {
-		radius = farthest;
-	}
-	radius *= area / maxArea;
-
-	return make_pair( pt, radius );
-}
-
-Extents<float> Stippler::getCellExtents( Stippler::EdgeList &edgeList ) {
-	using std::numeric_limits;
-
-	Extents<float> extent;
-
-	extent.minX = extent.minY = numeric_limits<float>::max();
-	extent.maxX = extent.maxY = numeric_limits<float>::min();
-
-	for ( EdgeList::iterator value_iter = edgeList.begin(); value_iter != edgeList.end(); ++value_iter ) {
-		if ( value_iter->begin.x < extent.minX ) extent.minX = value_iter->begin.x;
-		if ( value_iter->end.x < extent.minX ) extent.minX = value_iter->end.x;
-		if ( value_iter->begin.y < extent.minY ) extent.minY = value_iter->begin.y;
-		if ( value_iter->end.y < extent.minY ) extent.minY = value_iter->end.y;
-
-		if ( value_iter->begin.x > extent.maxX ) extent.maxX = value_iter->begin.x;
-		if ( value_iter->end.x > extent.maxX ) extent.maxX = value_iter->end.x;
-		if ( value_iter->begin.y > extent.maxY ) extent.maxY = value_iter->begin.y;
-		if ( value_iter->end.y > extent.maxY ) extent.maxY = value_iter->end.y;
-	}
-
-	return extent;
-}
-
-bool operator==(Point<float> const& p1, Point<float> const& p2)
-{
-	using std::abs;
-	using std::numeric_limits;
-
-	return abs( p1.x - p2.x ) < numeric_limits<float>::epsilon() && 
-		abs( p1.y - p2.y ) < numeric_limits<float>::epsilon();
-}
-
-std::size_t hash_value(Point<float> const& p) {
-	using std::size_t;
-	using boost::hash_combine;
-
-    size_t seed = 0;
-
-    hash_combine(seed, p.x);
-    hash_combine(seed, p.y);
-
-    return seed;
-}
-
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "stippler_impl.h"
+
+#include <fstream>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <thread>
+
+#include <boost/random.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#define STIPPLER_PAUSE
+#include <emmintrin.h>
+#endif
+
+#include "VoronoiDiagramGenerator.h"
+#include "DelaunayTriangulation.h"
+
+namespace {
+	// called on every pass of a wait for another thread. short waits pause
+	// the core, longer ones give up the time slice, which on a loaded machine
+	// the thread being waited for may need.
+	inline void backOff( unsigned int &spins ) {
+		if ( spins++ < 64 ) {
+#ifdef STIPPLER_PAUSE
+			_mm_pause();
+#endif
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	// whether (x, y) is on the inside of every clip line of a cell
+	inline bool isInsideCell( const std::vector< Line<float> > &clipLines, float x, float y ) {
+		for ( std::vector< Line<float> >::const_iterator iter = clipLines.begin(); iter != clipLines.end(); iter++ ) {
+			if ( x * iter->a + y * iter->b + iter->c >= 0.0f ) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// adds the moments of a row of samples. the vector kernels sum a row in
+	// single precision, which is short enough to lose nothing, so a double
+	// accumulator only has to take the total of every row
+	inline void sampleRow( SampleRowKernel kernel, const SampleRow &row, Moments<float> &moments ) {
+		kernel( row, moments );
+	}
+
+	inline void sampleRow( SampleRowKernel kernel, const SampleRow &row, Moments<double> &moments ) {
+		Moments<float> rowMoments = { 0.0f, 0.0f, 0.0f, 0.0f };
+		kernel( row, rowMoments );
+
+		moments.areaDensity += rowMoments.areaDensity;
+		moments.maxAreaDensity += rowMoments.maxAreaDensity;
+		moments.xSum += rowMoments.xSum;
+		moments.ySum += rowMoments.ySum;
+	}
+
+	// clips a convex polygon to the half plane nX * x + nY * y <= c. the
+	// labels name what lies across each side, side k running from vertex k
+	// to vertex k + 1, and the side cut along the line is labelled label.
+	void clipPolygon( std::vector< Point<float> > &polygon, std::vector< int > &labels, float nX, float nY, float c, int label,
+		std::vector< Point<float> > &clipped, std::vector< int > &clippedLabels ) {
+		size_t n = polygon.size();
+
+		clipped.clear();
+		clippedLabels.clear();
+
+		for ( size_t k = 0; k < n; k++ ) {
+			Point< float > &a = polygon[k], &b = polygon[( k + 1 ) % n];
+			float dA = nX * a.x + nY * a.y - c, dB = nX * b.x + nY * b.y - c;
+
+			if ( dA <= 0.0f ) {
+				clipped.push_back( a );
+				clippedLabels.push_back( labels[k] );
+			}
+
+			if ( ( dA <= 0.0f ) != ( dB <= 0.0f ) ) {
+				float t = dA / ( dA - dB );
+				Point< float > p = { a.x + t * ( b.x - a.x ), a.y + t * ( b.y - a.y ) };
+
+				clipped.push_back( p );
+				clippedLabels.push_back( dA <= 0.0f ? label : labels[k] );
+			}
+		}
+
+		polygon.swap( clipped );
+		labels.swap( clippedLabels );
+	}
+
+	// squared distance from (x, y) to the farthest vertex of a polygon
+	float farthestVertex( const std::vector< Point<float> > &polygon, float x, float y ) {
+		float farthest = 0.0f;
+		for ( std::vector< Point<float> >::const_iterator iter = polygon.begin(); iter != polygon.end(); ++iter ) {
+			farthest = std::max( farthest, ( iter->x - x ) * ( iter->x - x ) + ( iter->y - y ) * ( iter->y - y ) );
+		}
+		return farthest;
+	}
+
+	int threadCount() {
+#ifdef _OPENMP
+		return omp_get_max_threads();
+#else
+		return 1;
+#endif
+	}
+
+	int threadIndex() {
+#ifdef _OPENMP
+		return omp_get_thread_num();
+#else
+		return 0;
+#endif
+	}
+}
+
+Stippler::Stippler( const StipplingParameters &parameters )
+: IStippler(),
+generator(new VoronoiDiagramGenerator()),
+tileGenerators(parameters.sweepTiles > 1 ? new VoronoiDiagramGenerator[parameters.sweepTiles * parameters.sweepTiles] : NULL),
+triangulation(parameters.engine == VORONOI_DELAUNAY ? new DelaunayTriangulation() : NULL),
+tileHaloCapacity(0), tileEdgeCapacity(0), localEdgeCapacity(0),
+sampleKernel(parameters.noSimd ? NULL : selectSampleRowKernel()),
+vertsX(new float[parameters.points]), vertsY(new float[parameters.points]), radii(new float[parameters.points]),
+displacement(std::numeric_limits<float>::max()),
+iterations(0),
+image(parameters.inputFile),
+parameters(parameters) {
+	if ( parameters.centroidMethod == CENTROID_PREFIX_SUM ) {
+		image.createRowIntegrals();
+	}
+
+	if ( parameters.accumulator == ACCUMULATOR_DOUBLE ) {
+		switch ( parameters.sampler ) {
+		case SAMPLER_NEAREST: centroidKernel = selectCentroidKernel< NearestSampler, double >(); break;
+		case SAMPLER_BOX: centroidKernel = selectCentroidKernel< BoxSampler, double >(); break;
+		default: centroidKernel = selectCentroidKernel< BilinearSampler, double >(); break;
+		}
+	} else {
+		switch ( parameters.sampler ) {
+		case SAMPLER_NEAREST: centroidKernel = selectCentroidKernel< NearestSampler, float >(); break;
+		case SAMPLER_BOX: centroidKernel = selectCentroidKernel< BoxSampler, float >(); break;
+		default: centroidKernel = selectCentroidKernel< BilinearSampler, float >(); break;
+		}
+	}
+
+	std::memset( &statistics, 0, sizeof( statistics ) );
+
+	// only the scalar loops read the cache; the prefix sum integrator reads the
+	// row integrals and the vector kernels gather faster from the 8-bit map.
+	// an intensity cache too big for the budget is built at a lower density.
+	bool scalarSampling = parameters.centroidMethod == CENTROID_QUASI_RANDOM ||
+		( parameters.centroidMethod != CENTROID_PREFIX_SUM && sampleKernel == NULL );
+	if ( parameters.intensityCache > 0 && scalarSampling ) {
+		IntensitySampleFunction sample = parameters.sampler == SAMPLER_NEAREST ? &NearestSampler::sample :
+			parameters.sampler == SAMPLER_BOX ? &BoxSampler::sample : &BilinearSampler::sample;
+		statistics.intensityCacheDensity = image.createSupersampledIntensities( parameters.subpixels, (size_t)parameters.intensityCache << 20, sample );
+		statistics.intensityCacheMemory = (unsigned long)image.getSupersampledWidth() * image.getSupersampledHeight() * sizeof( float );
+	}
+
+	VoronoiDiagramGenerator::BeachLine beachLine = parameters.beachLine == SWEEP_BEACH_LINE_TREAP ?
+		VoronoiDiagramGenerator::BEACHLINE_TREAP : VoronoiDiagramGenerator::BEACHLINE_HASHED;
+	VoronoiDiagramGenerator::EventQueue eventQueue = parameters.eventQueue == SWEEP_EVENT_QUEUE_HEAP ?
+		VoronoiDiagramGenerator::EVENTQUEUE_HEAP : VoronoiDiagramGenerator::EVENTQUEUE_BUCKETED;
+	generator->setStructures( beachLine, eventQueue );
+	generator->setClosedCells( parameters.closedCells );
+	for ( unsigned int t = 0; tileGenerators && t < parameters.sweepTiles * parameters.sweepTiles; t++ ) {
+		tileGenerators[t].setStructures( beachLine, eventQueue );
+		tileGenerators[t].setClosedCells( parameters.closedCells );
+	}
+
+	siteIndices.resize( parameters.points );
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		siteIndices[i] = (int)i;
+	}
+
+	// the grid the local rebuilds find nearby sites in, about two sites to a
+	// bucket
+	float w = (float)(image.getWidth() - 1), h = (float)(image.getHeight() - 1);
+	gridSize = std::sqrt( 2.0f * w * h / parameters.points );
+	gridWidth = (int)std::ceil( w / gridSize ) + 1;
+	gridHeight = (int)std::ceil( h / gridSize ) + 1;
+
+	createInitialDistribution();
+}
+
+Stippler::~Stippler() {
+	delete generator;
+	delete[] tileGenerators;
+	delete triangulation;
+	delete[] radii;
+	delete[] vertsX;
+	delete[] vertsY;
+}
+
+void Stippler::distribute() {
+	using std::chrono::steady_clock;
+	using std::chrono::duration;
+
+	if ( parameters.reorderInterval > 0 && iterations++ % parameters.reorderInterval == 0 ) {
+		reorderSites();
+	}
+
+	steady_clock::time_point start = steady_clock::now();
+
+	// only full sweeps of open cells are pipelined. the other engines, the
+	// tiles and the closed cells only have whole diagrams to hand out.
+	bool pipelined = parameters.pipelinedSweep && parameters.engine == VORONOI_FORTUNE &&
+		parameters.sweepTiles <= 1 && !parameters.closedCells;
+
+	if ( findMovedSites() ) {
+		updateVoronoiDiagram();
+	} else if ( pipelined ) {
+		redistributeSweptStipples();
+		return;
+	} else {
+		createVoronoiDiagram();
+	}
+
+	statistics.diagramTime = duration<float>( steady_clock::now() - start ).count();
+	redistributeStipples();
+}
+
+float Stippler::getAverageDisplacement() {
+	return displacement;
+}
+
+void Stippler::getStatistics( StipplingStatistics *dst ) {
+	*dst = statistics;
+}
+
+void Stippler::createInitialDistribution() {
+	using std::ceil;
+
+	// find initial distribution
+	boost::mt19937 rng;
+	boost::uniform_01<boost::mt19937, float> generator( rng );
+
+	float w = (float)(image.getWidth() - 1), h = (float)(image.getHeight() - 1);
+	float xC, yC;
+
+	for ( unsigned int i = 0; i < parameters.points; ) {
+		xC = generator() * w;
+		yC = generator() * h;
+
+		// do a nearest neighbour search on the vertices
+		if ( ceil(generator() * 255.0f) <= image.getIntensity( xC, yC ) ) {
+			vertsX[i] = xC;
+			vertsY[i] = yC;
+			radii[i] = 0.0f;
+
+			i++;
+		}
+	}
+}
+
+void Stippler::getStipples( StipplePoint *dst ) {
+	StipplePoint *workingPtr;
+
+	for (unsigned int i = 0; i < parameters.points; i++ ) {
+		workingPtr = &(dst[siteIndices[i]]);
+
+		workingPtr->x = vertsX[i];
+		workingPtr->y = vertsY[i];
+		workingPtr->radius = radii[i];
+
+		image.getColour(vertsX[i], vertsY[i], workingPtr->r, workingPtr->g, workingPtr->b); 
+	}
+}
+
+void Stippler::reorderSites() {
+	using std::vector;
+	using std::pair;
+	using std::make_pair;
+	using std::sort;
+	using std::min;
+
+	// lay the sites out along a Hilbert curve, so that sites which are
+	// neighbours in the image are mostly neighbours in memory as well
+	float w = (float)(image.getWidth() - 1), h = (float)(image.getHeight() - 1);
+	vector< pair< unsigned int, int > > &keys = reorderKeys;
+	keys.resize( parameters.points );
+
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		unsigned int x = min( (unsigned int)( vertsX[i] / w * 65535.0f ), 65535u );
+		unsigned int y = min( (unsigned int)( vertsY[i] / h * 65535.0f ), 65535u );
+
+		keys[i] = make_pair( hilbertIndex( x, y ), (int)i );
+	}
+
+	sort( keys.begin(), keys.end() );
+
+	vector< float > &values = reorderValues;
+	vector< int > &indices = reorderSiteIndices, &newIndices = reorderIndices;
+	values.resize( parameters.points );
+	indices.resize( parameters.points );
+	newIndices.resize( parameters.points );
+
+	float *arrays[3] = { vertsX, vertsY, radii };
+	for ( int a = 0; a < 3; a++ ) {
+		for ( unsigned int i = 0; i < parameters.points; i++ ) {
+			values[i] = arrays[a][keys[i].second];
+		}
+		std::copy( values.begin(), values.end(), arrays[a] );
+	}
+
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		indices[i] = siteIndices[keys[i].second];
+		newIndices[keys[i].second] = (int)i;
+	}
+	siteIndices.swap( indices );
+
+	generator->renumberSites( newIndices );
+
+	// the diagram and the movement history refer to the old order, so the
+	// next iteration starts over from a full sweep with every cell active
+	diagramX.clear();
+	diagramY.clear();
+	siteMoves.clear();
+	cellCosts.clear();
+}
+
+void Stippler::createVoronoiDiagram() {
+	statistics.rebuiltCells = parameters.points;
+
+	// sites the triangulation cannot handle, such as all of them on one
+	// line, are left to the sweep
+	if ( triangulation && createDelaunayDiagram() ) {
+		return;
+	}
+
+	if ( parameters.sweepTiles > 1 ) {
+		createTiledVoronoiDiagram();
+		return;
+	}
+
+	generator->generateVoronoi( vertsX, vertsY, parameters.points, 
+		0.0f, (float)(image.getWidth() - 1), 0.0f, (float)(image.getHeight() - 1) );
+	statistics.diagramMemory = generator->getTotalAlloc();
+	statistics.sortTime = generator->getSortTime();
+
+	Edge< float > edge;
+
+	if ( parameters.closedCells ) {
+		// the rings come out site by site already, so their sides are the
+		// edges in order, with -1 across the ones along the image border
+		const VoronoiDiagramGenerator::GraphCells &cells = generator->getCells();
+
+		cellOffsets.resize( parameters.points + 1 );
+		cellOffsets[0] = 0;
+		cellEdges.clear();
+		cellNeighbours.clear();
+
+		for ( unsigned int i = 0; i < parameters.points; i++ ) {
+			int first = cells.offsets[i], last = cells.offsets[i + 1];
+
+			for ( int k = first; k < last; k++ ) {
+				int next = k + 1 < last ? k + 1 : first;
+
+				edge.begin.x = cells.x[k]; edge.begin.y = cells.y[k];
+				edge.end.x = cells.x[next]; edge.end.y = cells.y[next];
+
+				if ( !( edge.begin == edge.end ) ) {
+					cellEdges.push_back( edge );
+					cellNeighbours.push_back( cells.neighbour[k] );
+				}
+			}
+
+			cellOffsets[i + 1] = (int)cellEdges.size();
+		}
+
+		return;
+	}
+
+	const VoronoiDiagramGenerator::GraphEdges &output = generator->getEdges();
+
+	// count the edges of every cell, then lay them out site by site
+	cellOffsets.assign( parameters.points + 1, 0 );
+
+	for ( size_t i = 0; i < output.x1.size(); i++ ) {
+		edge.begin.x = output.x1[i]; edge.begin.y = output.y1[i];
+		edge.end.x = output.x2[i]; edge.end.y = output.y2[i];
+
+		if ( edge.begin == edge.end ) {
+			continue;
+		}
+
+		cellOffsets[output.site1[i] + 1]++;
+		cellOffsets[output.site2[i] + 1]++;
+	}
+
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		cellOffsets[i + 1] += cellOffsets[i];
+	}
+
+	cellEdges.resize( cellOffsets[parameters.points] );
+	cellNeighbours.resize( cellOffsets[parameters.points] );
+	cellFill.assign( cellOffsets.begin(), cellOffsets.end() - 1 );
+
+	for ( size_t i = 0; i < output.x1.size(); i++ ) {
+		edge.begin.x = output.x1[i]; edge.begin.y = output.y1[i];
+		edge.end.x = output.x2[i]; edge.end.y = output.y2[i];
+
+		if ( edge.begin == edge.end ) {
+			continue;
+		}
+
+		cellNeighbours[cellFill[output.site1[i]]] = output.site2[i];
+		cellEdges[cellFill[output.site1[i]]++] = edge;
+		cellNeighbours[cellFill[output.site2[i]]] = output.site1[i];
+		cellEdges[cellFill[output.site2[i]]++] = edge;
+	}
+}
+
+bool Stippler::createDelaunayDiagram() {
+	using std::vector;
+
+	if ( !triangulation->triangulate( vertsX, vertsY, parameters.points ) ) {
+		return false;
+	}
+
+	statistics.diagramMemory = triangulation->getTotalAlloc();
+	statistics.sortTime = triangulation->getSortTime();
+
+	const vector< int > &offsets = triangulation->getOffsets();
+	const vector< int > &neighbours = triangulation->getNeighbours();
+	const vector< int > &faces = triangulation->getFaces();
+	const vector< float > &centresX = triangulation->getCentresX();
+	const vector< float > &centresY = triangulation->getCentresY();
+
+	float w = (float)(image.getWidth() - 1), h = (float)(image.getHeight() - 1);
+	Point< float > corners[4] = { { 0.0f, 0.0f }, { w, 0.0f }, { w, h }, { 0.0f, h } };
+
+	createCellScratch();
+	vector< Point<float> > &polygon = cellPolygons[threadIndex()], &clipped = cellClippedPolygons[threadIndex()];
+	vector< int > &labels = cellLabels[threadIndex()], &clippedLabels = cellClippedLabels[threadIndex()];
+
+	cellOffsets.resize( parameters.points + 1 );
+	cellOffsets[0] = 0;
+	cellEdges.clear();
+	cellNeighbours.clear();
+
+	Edge< float > edge;
+
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		int first = offsets[i], last = offsets[i + 1];
+		bool inside = true;
+
+		for ( int k = first; k < last && inside; k++ ) {
+			int f = faces[k];
+			inside = f >= 0 && centresX[f] >= 0.0f && centresX[f] <= w && centresY[f] >= 0.0f && centresY[f] <= h;
+		}
+
+		if ( first == last ) {
+			// a site in the same place as an earlier one has no cell
+		} else if ( inside ) {
+			// the cell lies within the image, so its corners are the
+			// circumcentres of the triangles around the site
+			for ( int k = first; k < last; k++ ) {
+				int previous = faces[k > first ? k - 1 : last - 1];
+
+				edge.begin.x = centresX[previous]; edge.begin.y = centresY[previous];
+				edge.end.x = centresX[faces[k]]; edge.end.y = centresY[faces[k]];
+
+				if ( !( edge.begin == edge.end ) ) {
+					cellEdges.push_back( edge );
+					cellNeighbours.push_back( neighbours[k] );
+				}
+			}
+		} else {
+			// cut the image rectangle down by the bisectors with the Delaunay
+			// neighbours, which are the only sites that can bound the cell
+			float sX = vertsX[i], sY = vertsY[i];
+
+			polygon.assign( corners, corners + 4 );
+			labels.assign( 4, -1 );
+
+			for ( int k = first; k < last; k++ ) {
+				int other = neighbours[k];
+				float nX = vertsX[other] - sX, nY = vertsY[other] - sY;
+
+				clipPolygon( polygon, labels, nX, nY, ( nX * ( sX + vertsX[other] ) + nY * ( sY + vertsY[other] ) ) * 0.5f, other,
+					clipped, clippedLabels );
+			}
+
+			for ( size_t k = 0; k < polygon.size(); k++ ) {
+				edge.begin = polygon[k];
+				edge.end = polygon[( k + 1 ) % polygon.size()];
+
+				if ( ( labels[k] >= 0 || parameters.closedCells ) && !( edge.begin == edge.end ) ) {
+					cellEdges.push_back( edge );
+					cellNeighbours.push_back( labels[k] );
+				}
+			}
+		}
+
+		cellOffsets[i + 1] = (int)cellEdges.size();
+	}
+
+	return true;
+}
+
+bool Stippler::findMovedSites() {
+	float tolerance = parameters.rebuildTolerance;
+
+	if ( tolerance > 0.0f ) {
+		reserveLocalRebuild();
+	}
+
+	movedSites.clear();
+	if ( diagramX.size() == parameters.points ) {
+		for ( unsigned int i = 0; i < parameters.points; i++ ) {
+			float dX = vertsX[i] - diagramX[i], dY = vertsY[i] - diagramY[i];
+
+			if ( dX * dX + dY * dY > tolerance * tolerance ) {
+				movedSites.push_back( (int)i );
+			}
+		}
+	}
+
+	// every moved site drags its neighbouring cells along with it, and each
+	// of those is cut from its old neighbours first, so up to an eighth of
+	// the sites moving is still cheaper than a full sweep
+	if ( diagramX.size() != parameters.points || movedSites.size() > parameters.points / 8 ) {
+		diagramX.assign( vertsX, vertsX + parameters.points );
+		diagramY.assign( vertsY, vertsY + parameters.points );
+
+		return false;
+	}
+
+	return true;
+}
+
+void Stippler::reserveLocalRebuild() {
+	using std::max;
+
+	// the first local rebuild only comes once the stipples have settled, so
+	// its buffers are grown ahead of it. the ones sized by the sites are
+	// grown in full.
+	gridOffsets.reserve( gridWidth * gridHeight + 1 );
+	gridSites.reserve( parameters.points );
+	siteBuckets.reserve( parameters.points );
+	movedSites.reserve( parameters.points );
+	updatedSites.reserve( parameters.points );
+	updatedCells.reserve( parameters.points );
+	cellFill.reserve( parameters.points + 1 );
+	nextOffsets.reserve( parameters.points + 1 );
+
+	// the next layout is swapped with the current one, so it needs room for
+	// as many edges
+	nextEdges.reserve( cellEdges.capacity() );
+	nextNeighbours.reserve( cellNeighbours.capacity() );
+
+	// a sixteenth of the sites and the six or so cells around each of them
+	// hold under half of the edges. the buffers grow past that whenever a
+	// rebuild needed more. the threads share the cells out as they go, so
+	// any one of them may end up building all of them.
+	localEdgeCapacity = max( localEdgeCapacity, cellEdges.size() / 2 );
+	updatedEdges.resize( threadCount() );
+	for ( size_t t = 0; t < updatedEdges.size(); t++ ) {
+		updatedEdges[t].reserve( localEdgeCapacity );
+	}
+
+	createCellScratch();
+}
+
+void Stippler::updateVoronoiDiagram() {
+	using std::vector;
+
+	statistics.localRebuilds++;
+
+	updatedCells.assign( parameters.points, 0 );
+	updatedEdges.resize( threadCount() );
+	for ( size_t t = 0; t < updatedEdges.size(); t++ ) {
+		updatedEdges[t].clear();
+	}
+
+	if ( movedSites.empty() ) {
+		statistics.rebuiltCells = 0;
+		return;
+	}
+
+	createSiteGrid();
+
+	// the cells of the moved sites come first, since the sites they border
+	// now have to be redone along with the ones they used to border
+	for ( vector< int >::iterator iter = movedSites.begin(); iter != movedSites.end(); ++iter ) {
+		updatedCells[*iter] = 1;
+	}
+
+	createCellScratch();
+
+	#pragma omp parallel for schedule(dynamic, 16)
+	for ( int m = 0; m < (int)movedSites.size(); m++ ) {
+		createLocalCell( movedSites[m], updatedEdges[threadIndex()] );
+	}
+
+	updatedSites.clear();
+	for ( vector< int >::iterator iter = movedSites.begin(); iter != movedSites.end(); ++iter ) {
+		for ( int j = cellOffsets[*iter]; j < cellOffsets[*iter + 1]; j++ ) {
+			if ( cellNeighbours[j] >= 0 && !updatedCells[cellNeighbours[j]] ) {
+				updatedCells[cellNeighbours[j]] = 1;
+				updatedSites.push_back( cellNeighbours[j] );
+			}
+		}
+	}
+	for ( size_t t = 0; t < updatedEdges.size(); t++ ) {
+		for ( vector< CellEdge >::iterator iter = updatedEdges[t].begin(); iter != updatedEdges[t].end(); ++iter ) {
+			if ( iter->neighbour >= 0 && !updatedCells[iter->neighbour] ) {
+				updatedCells[iter->neighbour] = 1;
+				updatedSites.push_back( iter->neighbour );
+			}
+		}
+	}
+
+	#pragma omp parallel for schedule(dynamic, 16)
+	for ( int u = 0; u < (int)updatedSites.size(); u++ ) {
+		createLocalCell( updatedSites[u], updatedEdges[threadIndex()] );
+	}
+
+	statistics.rebuiltCells = (unsigned int)( movedSites.size() + updatedSites.size() );
+	size_t localEdges = 0;
+	for ( size_t t = 0; t < updatedEdges.size(); t++ ) {
+		localEdges += updatedEdges[t].size();
+	}
+	if ( localEdges > localEdgeCapacity ) {
+		localEdgeCapacity = localEdges + localEdges / 8;
+	}
+
+	// lay the cells out again, copying over the ones which did not change
+	cellFill.assign( parameters.points, 0 );
+	for ( size_t t = 0; t < updatedEdges.size(); t++ ) {
+		for ( vector< CellEdge >::iterator iter = updatedEdges[t].begin(); iter != updatedEdges[t].end(); ++iter ) {
+			cellFill[iter->site]++;
+		}
+	}
+
+	nextOffsets.resize( parameters.points + 1 );
+	nextOffsets[0] = 0;
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		int count = updatedCells[i] ? cellFill[i] : cellOffsets[i + 1] - cellOffsets[i];
+		nextOffsets[i + 1] = nextOffsets[i] + count;
+	}
+
+	nextEdges.resize( nextOffsets[parameters.points] );
+	nextNeighbours.resize( nextOffsets[parameters.points] );
+
+	#pragma omp parallel for
+	for ( int i = 0; i < (int)parameters.points; i++ ) {
+		if ( !updatedCells[i] ) {
+			std::copy( cellEdges.begin() + cellOffsets[i], cellEdges.begin() + cellOffsets[i + 1], nextEdges.begin() + nextOffsets[i] );
+			std::copy( cellNeighbours.begin() + cellOffsets[i], cellNeighbours.begin() + cellOffsets[i + 1], nextNeighbours.begin() + nextOffsets[i] );
+		}
+	}
+
+	cellFill.assign( nextOffsets.begin(), nextOffsets.end() - 1 );
+	for ( size_t t = 0; t < updatedEdges.size(); t++ ) {
+		for ( vector< CellEdge >::iterator iter = updatedEdges[t].begin(); iter != updatedEdges[t].end(); ++iter ) {
+			nextNeighbours[cellFill[iter->site]] = iter->neighbour;
+			nextEdges[cellFill[iter->site]++] = iter->edge;
+		}
+	}
+
+	cellOffsets.swap( nextOffsets );
+	cellEdges.swap( nextEdges );
+	cellNeighbours.swap( nextNeighbours );
+
+	for ( vector< int >::iterator iter = movedSites.begin(); iter != movedSites.end(); ++iter ) {
+		diagramX[*iter] = vertsX[*iter];
+		diagramY[*iter] = vertsY[*iter];
+	}
+}
+
+void Stippler::createSiteGrid() {
+	using std::min;
+
+	gridOffsets.assign( gridWidth * gridHeight + 1, 0 );
+	gridSites.resize( parameters.points );
+	siteBuckets.resize( parameters.points );
+
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		int gX = min( (int)( vertsX[i] / gridSize ), gridWidth - 1 );
+		int gY = min( (int)( vertsY[i] / gridSize ), gridHeight - 1 );
+
+		siteBuckets[i] = gY * gridWidth + gX;
+		gridOffsets[siteBuckets[i]]++;
+	}
+	for ( int g = 1; g <= gridWidth * gridHeight; g++ ) {
+		gridOffsets[g] += gridOffsets[g - 1];
+	}
+	for ( int i = (int)parameters.points - 1; i >= 0; i-- ) {
+		gridSites[--gridOffsets[siteBuckets[i]]] = i;
+	}
+}
+
+void Stippler::createLocalCell( int site, std::vector< CellEdge > &output ) {
+	using std::vector;
+	using std::min;
+	using std::max;
+	using std::numeric_limits;
+
+	float w = (float)(image.getWidth() - 1), h = (float)(image.getHeight() - 1);
+	float sX = vertsX[site], sY = vertsY[site];
+
+	// start from the image rectangle and cut it down by the bisector of every
+	// site near enough to matter, nearest buckets first
+	Point< float > corners[4] = { { 0.0f, 0.0f }, { w, 0.0f }, { w, h }, { 0.0f, h } };
+	vector< Point<float> > &polygon = cellPolygons[threadIndex()], &clipped = cellClippedPolygons[threadIndex()];
+	vector< int > &labels = cellLabels[threadIndex()], &clippedLabels = cellClippedLabels[threadIndex()];
+
+	polygon.assign( corners, corners + 4 );
+	labels.assign( 4, -1 );
+
+	// the sites barely moved, so the old neighbours cut the rectangle down to
+	// nearly the new cell. a site can then only cut it further if it is
+	// nearer than twice the farthest vertex, which rules out most of the
+	// sites in the buckets without clipping against them.
+	int firstNeighbour = cellOffsets[site], lastNeighbour = cellOffsets[site + 1];
+	for ( int k = firstNeighbour; k < lastNeighbour; k++ ) {
+		int other = cellNeighbours[k];
+		if ( other < 0 ) {
+			continue;
+		}
+
+		float nX = vertsX[other] - sX, nY = vertsY[other] - sY;
+		if ( nX == 0.0f && nY == 0.0f ) {
+			if ( other < site ) {
+				return;
+			}
+			continue;
+		}
+
+		clipPolygon( polygon, labels, nX, nY, ( nX * ( sX + vertsX[other] ) + nY * ( sY + vertsY[other] ) ) * 0.5f, other,
+			clipped, clippedLabels );
+	}
+
+	float farthest = farthestVertex( polygon, sX, sY );
+	int bX = siteBuckets[site] % gridWidth, bY = siteBuckets[site] / gridWidth;
+
+	for ( int ring = 0; ; ring++ ) {
+		int firstX = bX - ring, lastX = bX + ring, firstY = bY - ring, lastY = bY + ring;
+
+		for ( int gY = max( firstY, 0 ); gY <= min( lastY, gridHeight - 1 ); gY++ ) {
+			for ( int gX = max( firstX, 0 ); gX <= min( lastX, gridWidth - 1 ); gX++ ) {
+				// the inside of the ring was visited already
+				if ( gY != firstY && gY != lastY && gX != firstX && gX != lastX ) {
+					gX = lastX - 1;
+					continue;
+				}
+
+				for ( int j = gridOffsets[gY * gridWidth + gX]; j < gridOffsets[gY * gridWidth + gX + 1]; j++ ) {
+					int other = gridSites[j];
+					float nX = vertsX[other] - sX, nY = vertsY[other] - sY;
+
+					if ( nX == 0.0f && nY == 0.0f ) {
+						// of two sites in the same place only the first gets a cell
+						if ( other < site ) {
+							return;
+						}
+						continue;
+					}
+
+					if ( nX * nX + nY * nY >= 4.0f * farthest ||
+						std::find( cellNeighbours.begin() + firstNeighbour, cellNeighbours.begin() + lastNeighbour, other ) != cellNeighbours.begin() + lastNeighbour ) {
+						continue;
+					}
+
+					clipPolygon( polygon, labels, nX, nY, ( nX * ( sX + vertsX[other] ) + nY * ( sY + vertsY[other] ) ) * 0.5f, other,
+						clipped, clippedLabels );
+					farthest = farthestVertex( polygon, sX, sY );
+				}
+			}
+		}
+
+		// the sites past the ring are at least reach away, and can only cut off
+		// the parts of the cell further than half of that from its site
+		float reach = numeric_limits<float>::max();
+		if ( firstX > 0 ) reach = min( reach, sX - firstX * gridSize );
+		if ( lastX < gridWidth - 1 ) reach = min( reach, ( lastX + 1 ) * gridSize - sX );
+		if ( firstY > 0 ) reach = min( reach, sY - firstY * gridSize );
+		if ( lastY < gridHeight - 1 ) reach = min( reach, ( lastY + 1 ) * gridSize - sY );
+
+		if ( reach == numeric_limits<float>::max() ) {
+			break;
+		}
+
+		if ( 4.0f * farthest <= reach * reach ) {
+			break;
+		}
+	}
+
+	CellEdge cellEdge;
+	cellEdge.site = site;
+
+	for ( size_t k = 0; k < polygon.size(); k++ ) {
+		cellEdge.neighbour = labels[k];
+		cellEdge.edge.begin = polygon[k];
+		cellEdge.edge.end = polygon[( k + 1 ) % polygon.size()];
+
+		// the sides along the image border are not edges of the diagram,
+		// unless the cells are to be closed
+		if ( ( cellEdge.neighbour >= 0 || parameters.closedCells ) && !( cellEdge.edge.begin == cellEdge.edge.end ) ) {
+			output.push_back( cellEdge );
+		}
+	}
+}
+
+void Stippler::createCellScratch() {
+	// the buffers keep their capacity from one iteration to the next
+	int threads = threadCount();
+
+	cellClipLines.resize( threads );
+	cellPolygons.resize( threads );
+	cellClippedPolygons.resize( threads );
+	cellLabels.resize( threads );
+	cellClippedLabels.resize( threads );
+
+	// a cell has one clip line per edge and its polygon at most one more side
+	// per clip, and no cell comes near this many. any thread can be handed
+	// the largest cell, so they are all grown for it up front.
+	for ( int t = 0; t < threads; t++ ) {
+		cellClipLines[t].reserve( 64 );
+		cellPolygons[t].reserve( 64 );
+		cellClippedPolygons[t].reserve( 64 );
+		cellLabels[t].reserve( 64 );
+		cellClippedLabels[t].reserve( 64 );
+	}
+}
+
+int Stippler::getTile( float x, float y ) {
+	using std::min;
+
+	int tiles = (int)parameters.sweepTiles;
+	int tX = min( (int)( x * tiles / (float)(image.getWidth() - 1) ), tiles - 1 );
+	int tY = min( (int)( y * tiles / (float)(image.getHeight() - 1) ), tiles - 1 );
+
+	return tY * tiles + tX;
+}
+
+void Stippler::createTiledVoronoiDiagram() {
+	using std::sqrt;
+	using std::vector;
+	using std::numeric_limits;
+
+	int tiles = (int)parameters.sweepTiles;
+	float w = (float)(image.getWidth() - 1), h = (float)(image.getHeight() - 1);
+	float tileWidth = w / tiles, tileHeight = h / tiles;
+
+	// bucket the sites by the tile that owns them
+	tileOffsets.assign( tiles * tiles + 1, 0 );
+	tileSites.resize( parameters.points );
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		tileOffsets[getTile( vertsX[i], vertsY[i] ) + 1]++;
+	}
+	for ( int t = 0; t < tiles * tiles; t++ ) {
+		tileOffsets[t + 1] += tileOffsets[t];
+	}
+	cellFill.assign( tileOffsets.begin(), tileOffsets.end() - 1 );
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		tileSites[cellFill[getTile( vertsX[i], vertsY[i] )]++] = (int)i;
+	}
+
+	tileX.resize( tiles * tiles );
+	tileY.resize( tiles * tiles );
+	tileIndices.resize( tiles * tiles );
+	tileEdges.resize( tiles * tiles );
+
+	// stipples drift from one tile's halo into another's, so every tile is
+	// grown to the largest halo and the most edges of any tile so far
+	for ( int t = 0; t < tiles * tiles; t++ ) {
+		tileX[t].reserve( tileHaloCapacity );
+		tileY[t].reserve( tileHaloCapacity );
+		tileIndices[t].reserve( tileHaloCapacity );
+		tileEdges[t].reserve( tileEdgeCapacity );
+		tileGenerators[t].reserve( (int)tileHaloCapacity );
+	}
+
+	// the halo starts at a couple of average stipple spacings and doubles
+	// whenever a tile cannot prove that its cells are complete
+	float spacing = sqrt( w * h / parameters.points );
+
+	#pragma omp parallel for schedule(dynamic)
+	for ( int t = 0; t < tiles * tiles; t++ ) {
+		vector< CellEdge > &owned = tileEdges[t];
+		vector< float > &xValues = tileX[t], &yValues = tileY[t];
+		vector< int > &indices = tileIndices[t];
+
+		float x0 = ( t % tiles ) * tileWidth, x1 = x0 + tileWidth;
+		float y0 = ( t / tiles ) * tileHeight, y1 = y0 + tileHeight;
+
+		for ( float halo = 2.0f * spacing; ; halo *= 2.0f ) {
+			// there are no sites past the image border, so a halo which reaches
+			// it is as good as an infinite one
+			float minX = x0 - halo > 0.0f ? x0 - halo : -numeric_limits<float>::max();
+			float minY = y0 - halo > 0.0f ? y0 - halo : -numeric_limits<float>::max();
+			float maxX = x1 + halo < w ? x1 + halo : numeric_limits<float>::max();
+			float maxY = y1 + halo < h ? y1 + halo : numeric_limits<float>::max();
+
+			xValues.clear();
+			yValues.clear();
+			indices.clear();
+			int firstX = x0 - halo > 0.0f ? (int)( ( x0 - halo ) / tileWidth ) : 0;
+			int firstY = y0 - halo > 0.0f ? (int)( ( y0 - halo ) / tileHeight ) : 0;
+			int lastX = x1 + halo < w ? (int)( ( x1 + halo ) / tileWidth ) : tiles - 1;
+			int lastY = y1 + halo < h ? (int)( ( y1 + halo ) / tileHeight ) : tiles - 1;
+
+			for ( int tY = firstY; tY <= lastY && tY < tiles; tY++ ) {
+				for ( int tX = firstX; tX <= lastX && tX < tiles; tX++ ) {
+					for ( int j = tileOffsets[tY * tiles + tX]; j < tileOffsets[tY * tiles + tX + 1]; j++ ) {
+						int i = tileSites[j];
+
+						if ( vertsX[i] >= minX && vertsX[i] <= maxX && vertsY[i] >= minY && vertsY[i] <= maxY ) {
+							xValues.push_back( vertsX[i] );
+							yValues.push_back( vertsY[i] );
+							indices.push_back( i );
+						}
+					}
+				}
+			}
+
+			owned.clear();
+			if ( xValues.empty() ) {
+				break;
+			}
+
+			VoronoiDiagramGenerator &generator = tileGenerators[t];
+			generator.generateVoronoi( &xValues[0], &yValues[0], (int)xValues.size(), 0.0f, w, 0.0f, h );
+
+			// a cell is complete if none of its vertices can have a site outside
+			// of the halo closer to it than the cell's own site. the bounding
+			// box corners are vertices of the cells nearest to them.
+			bool complete = true;
+			const VoronoiDiagramGenerator::GraphEdges &output = generator.getEdges();
+			CellEdge cellEdge;
+			Edge< float > &edge = cellEdge.edge;
+
+			for ( size_t e = 0; e < output.x1.size(); e++ ) {
+				edge.begin.x = output.x1[e]; edge.begin.y = output.y1[e];
+				edge.end.x = output.x2[e]; edge.end.y = output.y2[e];
+
+				if ( edge.begin == edge.end ) {
+					continue;
+				}
+
+				int sites[2] = { indices[output.site1[e]], indices[output.site2[e]] };
+				for ( int k = 0; k < 2; k++ ) {
+					Point< float > p = { vertsX[sites[k]], vertsY[sites[k]] };
+
+					if ( getTile( p.x, p.y ) != t ) {
+						continue;
+					}
+
+					Point< float > vertices[2] = { edge.begin, edge.end };
+					for ( int v = 0; v < 2; v++ ) {
+						float r = sqrt( ( vertices[v].x - p.x ) * ( vertices[v].x - p.x ) + ( vertices[v].y - p.y ) * ( vertices[v].y - p.y ) );
+
+						if ( vertices[v].x - r < minX || vertices[v].x + r > maxX || vertices[v].y - r < minY || vertices[v].y + r > maxY ) {
+							complete = false;
+						}
+					}
+
+					cellEdge.site = sites[k];
+					cellEdge.neighbour = sites[1 - k];
+					owned.push_back( cellEdge );
+				}
+			}
+
+			for ( int c = 0; c < 4 && complete; c++ ) {
+				float cX = c & 1 ? w : 0.0f, cY = c & 2 ? h : 0.0f;
+				float nearest = numeric_limits<float>::max();
+				size_t site = 0;
+
+				for ( size_t j = 0; j < xValues.size(); j++ ) {
+					float d = ( xValues[j] - cX ) * ( xValues[j] - cX ) + ( yValues[j] - cY ) * ( yValues[j] - cY );
+					if ( d < nearest ) {
+						nearest = d;
+						site = j;
+					}
+				}
+
+				float r = sqrt( nearest );
+				if ( getTile( xValues[site], yValues[site] ) == t &&
+					( cX - r < minX || cX + r > maxX || cY - r < minY || cY + r > maxY ) ) {
+					complete = false;
+				}
+			}
+
+			if ( complete ) {
+				if ( parameters.closedCells ) {
+					// the cells are known to be right, so swap the edges for the
+					// closed rings of the sites the tile owns
+					const VoronoiDiagramGenerator::GraphCells &cells = generator.getCells();
+					owned.clear();
+
+					for ( size_t j = 0; j < xValues.size(); j++ ) {
+						if ( getTile( xValues[j], yValues[j] ) != t ) {
+							continue;
+						}
+
+						int first = cells.offsets[j], last = cells.offsets[j + 1];
+						cellEdge.site = indices[j];
+
+						for ( int k = first; k < last; k++ ) {
+							int next = k + 1 < last ? k + 1 : first;
+
+							edge.begin.x = cells.x[k]; edge.begin.y = cells.y[k];
+							edge.end.x = cells.x[next]; edge.end.y = cells.y[next];
+							cellEdge.neighbour = cells.neighbour[k] >= 0 ? indices[cells.neighbour[k]] : -1;
+
+							if ( !( edge.begin == edge.end ) ) {
+								owned.push_back( cellEdge );
+							}
+						}
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	// a tile which outgrew the others grows them all for the next iteration,
+	// with some slack like the generators' arenas
+	for ( int t = 0; t < tiles * tiles; t++ ) {
+		if ( tileX[t].size() > tileHaloCapacity ) {
+			tileHaloCapacity = tileX[t].size() + tileX[t].size() / 8;
+		}
+		if ( tileEdges[t].size() > tileEdgeCapacity ) {
+			tileEdgeCapacity = tileEdges[t].size() + tileEdges[t].size() / 8;
+		}
+	}
+
+	statistics.diagramMemory = 0;
+	cellOffsets.assign( parameters.points + 1, 0 );
+
+	// every site is owned by exactly one tile, so the tiles can count and lay
+	// out their own cells independently
+	#pragma omp parallel for
+	for ( int t = 0; t < tiles * tiles; t++ ) {
+		for ( vector< CellEdge >::iterator iter = tileEdges[t].begin(); iter != tileEdges[t].end(); ++iter ) {
+			cellOffsets[iter->site + 1]++;
+		}
+	}
+
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		cellOffsets[i + 1] += cellOffsets[i];
+	}
+
+	cellEdges.resize( cellOffsets[parameters.points] );
+	cellNeighbours.resize( cellOffsets[parameters.points] );
+	cellFill.assign( cellOffsets.begin(), cellOffsets.end() - 1 );
+
+	#pragma omp parallel for
+	for ( int t = 0; t < tiles * tiles; t++ ) {
+		for ( vector< CellEdge >::iterator iter = tileEdges[t].begin(); iter != tileEdges[t].end(); ++iter ) {
+			cellNeighbours[cellFill[iter->site]] = iter->neighbour;
+			cellEdges[cellFill[iter->site]++] = iter->edge;
+		}
+	}
+
+	// the tiles sort concurrently, so this is the sum of their sorting time
+	statistics.sortTime = 0.0f;
+	for ( int t = 0; t < tiles * tiles; t++ ) {
+		statistics.diagramMemory += tileGenerators[t].getTotalAlloc();
+		statistics.sortTime += tileGenerators[t].getSortTime();
+	}
+}
+
+void Stippler::redistributeStipples() {
+	using std::min;
+	using std::chrono::steady_clock;
+	using std::chrono::duration;
+
+	float local_displacement = 0.0f;
+	int cells = 0, active = 0;
+	unsigned long samples = 0;
+
+	prepareRedistribution();
+	orderCells();
+
+	// the largest cells go first, one at a time, so by the time the threads
+	// pull the last of the small ones off the queue they have about the same
+	// work done. chunks of them would hand one thread several of the largest.
+	int threads = min( threadCount(), STIPPLER_MAX_THREADS );
+	statistics.threads = (unsigned int)threads;
+	for ( int t = 0; t < threads; t++ ) {
+		statistics.busyTime[t] = 0.0f;
+	}
+
+	steady_clock::time_point start = steady_clock::now();
+
+	#pragma omp parallel reduction(+:local_displacement,cells,active,samples)
+	{
+		#pragma omp for schedule(dynamic, 1) nowait
+		for (int n = 0; n < (int)parameters.points; n++) {
+			int i = cellOrder[n];
+
+			if ( cellOffsets[i] == cellOffsets[i + 1] ) {
+				// the site has no cell, which only happens to duplicate sites
+				continue;
+			}
+
+			cells++;
+
+			if ( redistributeCell( i, cellEdges.data() + cellOffsets[i], cellEdges.data() + cellOffsets[i + 1], cellNeighbours.data() + cellOffsets[i], samples ) ) {
+				local_displacement += nextMoves[i];
+				active++;
+			}
+		}
+
+		if ( threadIndex() < threads ) {
+			statistics.busyTime[threadIndex()] = duration<float>( steady_clock::now() - start ).count();
+		}
+	}
+
+	// the threads which ran out of cells early waited for the rest
+	float elapsed = duration<float>( steady_clock::now() - start ).count();
+	for ( int t = 0; t < threads; t++ ) {
+		statistics.idleTime[t] = elapsed - statistics.busyTime[t];
+	}
+
+	finishRedistribution( local_displacement, cells, active, samples );
+}
+
+void Stippler::redistributeSweptStipples() {
+	using std::min;
+	using std::chrono::steady_clock;
+	using std::chrono::duration;
+
+	float local_displacement = 0.0f;
+	int cells = 0, active = 0;
+	unsigned long samples = 0;
+
+	statistics.rebuiltCells = parameters.points;
+	prepareRedistribution();
+
+	// a Voronoi diagram has at most 3n - 6 edges, each on the side of two
+	// cells, so the buffers never have to grow while they are being read
+	sweptSites.resize( parameters.points );
+	sweptOffsets.resize( parameters.points + 1 );
+	sweptOffsets[0] = 0;
+	sweptEdges.resize( 6 * parameters.points + 6 );
+	sweptNeighbours.resize( 6 * parameters.points + 6 );
+	sweptCells = sweptClaims = sweptDone = 0;
+
+	if ( cellCosts.size() != parameters.points ) {
+		cellCosts.assign( parameters.points, 0.0f );
+	}
+
+	int threads = min( threadCount(), STIPPLER_MAX_THREADS );
+	statistics.threads = (unsigned int)threads;
+	for ( int t = 0; t < threads; t++ ) {
+		statistics.busyTime[t] = 0.0f;
+	}
+
+	generator->setCellCallback( &Stippler::completeSweptCell, this );
+
+	steady_clock::time_point start = steady_clock::now();
+
+	// the first thread sweeps, and then joins the others in integrating the
+	// cells in the order the sweep completed them. the sweep counts towards
+	// its busy time, and waiting for it towards the idle time of the others.
+	// Visual C++ only has OpenMP 2.0, without atomic reads and writes, so the
+	// counts are handed between the threads with flushes.
+	#pragma omp parallel reduction(+:local_displacement,cells,active,samples)
+	{
+		float waiting = 0.0f;
+
+		if ( threadIndex() == 0 ) {
+			generator->generateVoronoi( vertsX, vertsY, parameters.points,
+				0.0f, (float)(image.getWidth() - 1), 0.0f, (float)(image.getHeight() - 1) );
+			statistics.diagramTime = duration<float>( steady_clock::now() - start ).count();
+
+			#pragma omp flush
+			sweptDone = 1;
+			#pragma omp flush
+		}
+
+		for ( ;; ) {
+			int n, available, done;
+
+			#pragma omp critical(sweptClaims)
+			n = sweptClaims++;
+
+			// the flag is read first, so once it is set the count is final
+			#pragma omp flush
+			done = sweptDone;
+			#pragma omp flush
+			available = sweptCells;
+
+			if ( n >= available && !done ) {
+				steady_clock::time_point wait = steady_clock::now();
+
+				for ( unsigned int spins = 0; n >= available && !done; ) {
+					backOff( spins );
+
+					#pragma omp flush
+					done = sweptDone;
+					#pragma omp flush
+					available = sweptCells;
+				}
+
+				waiting += duration<float>( steady_clock::now() - wait ).count();
+			}
+
+			if ( n >= available ) {
+				break;
+			}
+
+			#pragma omp flush
+
+			int i = sweptSites[n];
+			if ( sweptOffsets[n] == sweptOffsets[n + 1] ) {
+				continue;
+			}
+
+			cells++;
+
+			if ( redistributeCell( i, sweptEdges.data() + sweptOffsets[n], sweptEdges.data() + sweptOffsets[n + 1], sweptNeighbours.data() + sweptOffsets[n], samples ) ) {
+				local_displacement += nextMoves[i];
+				active++;
+			}
+		}
+
+		if ( threadIndex() < threads ) {
+			statistics.busyTime[threadIndex()] = duration<float>( steady_clock::now() - start ).count() - waiting;
+		}
+	}
+
+	float elapsed = duration<float>( steady_clock::now() - start ).count();
+	for ( int t = 0; t < threads; t++ ) {
+		statistics.idleTime[t] = elapsed - statistics.busyTime[t];
+	}
+
+	generator->setCellCallback( NULL, NULL );
+	statistics.diagramMemory = generator->getTotalAlloc();
+	statistics.sortTime = generator->getSortTime();
+
+	// lay the cells out site by site for the next iteration
+	cellOffsets.assign( parameters.points + 1, 0 );
+	for ( int n = 0; n < sweptCells; n++ ) {
+		cellOffsets[sweptSites[n] + 1] = sweptOffsets[n + 1] - sweptOffsets[n];
+	}
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		cellOffsets[i + 1] += cellOffsets[i];
+	}
+
+	cellEdges.resize( cellOffsets[parameters.points] );
+	cellNeighbours.resize( cellOffsets[parameters.points] );
+	for ( int n = 0; n < sweptCells; n++ ) {
+		std::copy( sweptEdges.begin() + sweptOffsets[n], sweptEdges.begin() + sweptOffsets[n + 1], cellEdges.begin() + cellOffsets[sweptSites[n]] );
+		std::copy( sweptNeighbours.begin() + sweptOffsets[n], sweptNeighbours.begin() + sweptOffsets[n + 1], cellNeighbours.begin() + cellOffsets[sweptSites[n]] );
+	}
+
+	finishRedistribution( local_displacement, cells, active, samples );
+}
+
+void Stippler::completeSweptCell( void *context, int site ) {
+	Stippler *stippler = (Stippler *)context;
+	VoronoiDiagramGenerator *generator = stippler->generator;
+	const VoronoiDiagramGenerator::GraphEdges &output = generator->getEdges();
+
+	// only the sweep writes the count, so it can read it without care
+	int n = stippler->sweptCells, fill = stippler->sweptOffsets[n];
+	Edge< float > edge;
+
+	for ( int e = generator->getFirstCellEdge( site ); e != NIL; e = generator->getNextCellEdge( e, site ) ) {
+		edge.begin.x = output.x1[e]; edge.begin.y = output.y1[e];
+		edge.end.x = output.x2[e]; edge.end.y = output.y2[e];
+
+		if ( edge.begin == edge.end ) {
+			continue;
+		}
+
+		stippler->sweptEdges[fill] = edge;
+		stippler->sweptNeighbours[fill++] = output.site1[e] == site ? output.site2[e] : output.site1[e];
+	}
+
+	stippler->sweptSites[n] = site;
+	stippler->sweptOffsets[n + 1] = fill;
+
+	// publish the cell only after everything in it is written
+	#pragma omp flush
+	stippler->sweptCells = n + 1;
+	#pragma omp flush
+}
+
+void Stippler::prepareRedistribution() {
+	using std::numeric_limits;
+
+	if ( siteMoves.size() != parameters.points ) {
+		siteMoves.assign( parameters.points, numeric_limits<float>::max() );
+		activeSites.assign( parameters.points, 1 );
+	}
+	nextMoves.assign( parameters.points, 0.0f );
+
+	createCellScratch();
+}
+
+bool Stippler::redistributeCell( int i, EdgeIterator first, EdgeIterator last, const int *neighbours, unsigned long &samples ) {
+	using std::pow;
+	using std::sqrt;
+	using std::pair;
+
+	float tolerance = parameters.activeTolerance;
+
+	// a cell whose site and neighbours all stayed put has the same polygon,
+	// and so the same centroid, as the last time it was integrated
+	bool changed = activeSites[i] || siteMoves[i] > tolerance;
+	for ( const int *j = neighbours; j != neighbours + ( last - first ) && !changed; j++ ) {
+		changed = *j >= 0 && siteMoves[*j] > tolerance;
+	}
+
+	if ( !changed ) {
+		return false;
+	}
+
+	Point< float > site = { vertsX[i], vertsY[i] };
+	unsigned int cellSamples = 0;
+	pair< Point<float>, float > centroid = (this->*centroidKernel)( site, first, last, neighbours, cellSamples );
+	samples += cellSamples;
+	cellCosts[i] = (float)cellSamples;
+
+	radii[i] = centroid.second;
+	vertsX[i] = centroid.first.x;
+	vertsY[i] = centroid.first.y;
+
+	nextMoves[i] = sqrt( pow( site.x - centroid.first.x, 2.0f ) + pow( site.y - centroid.first.y, 2.0f ) );
+
+	return true;
+}
+
+void Stippler::finishRedistribution( float totalDisplacement, int cells, int active, unsigned long samples ) {
+	float tolerance = parameters.activeTolerance;
+
+	// the sites which moved can leave the cells they border now, and those
+	// cells have to be integrated again next time even if the sites are no
+	// longer neighbours by then
+	activeSites.assign( parameters.points, 0 );
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		if ( nextMoves[i] > tolerance ) {
+			activeSites[i] = 1;
+			for ( int j = cellOffsets[i]; j < cellOffsets[i + 1]; j++ ) {
+				if ( cellNeighbours[j] >= 0 ) {
+					activeSites[cellNeighbours[j]] = 1;
+				}
+			}
+		}
+	}
+
+	siteMoves.swap( nextMoves );
+	statistics.activeCells = (unsigned int)active;
+	statistics.samples = samples;
+
+	displacement = totalDisplacement / cells; // average out the displacement
+}
+
+void Stippler::orderCells() {
+	using std::ilogb;
+	using std::min;
+
+	// the cells are bucketed by the power of two of their cost, which is as
+	// fine an order as the estimates are good for
+	const int buckets = 32;
+	int bucketOffsets[buckets + 1] = { 0 };
+	float density = (float)parameters.subpixels;
+
+	if ( cellCosts.size() != parameters.points ) {
+		cellCosts.assign( parameters.points, 0.0f );
+	}
+	cellOrder.resize( parameters.points );
+	cellBuckets.resize( parameters.points );
+
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		float cost = cellCosts[i];
+
+		// a cell which was not integrated yet costs about as many samples as
+		// its bounding box holds
+		if ( cost <= 0.0f && cellOffsets[i] < cellOffsets[i + 1] ) {
+			Extents<float> extent = getCellExtents( cellEdges.data() + cellOffsets[i], cellEdges.data() + cellOffsets[i + 1] );
+			cost = parameters.cellSamples > 0 ? (float)parameters.cellSamples :
+				( extent.maxX - extent.minX ) * ( extent.maxY - extent.minY ) * density * density;
+		}
+
+		cellBuckets[i] = buckets - 1 - ( cost >= 1.0f ? min( ilogb( cost ), buckets - 1 ) : 0 );
+		bucketOffsets[cellBuckets[i] + 1]++;
+	}
+
+	for ( int b = 0; b < buckets; b++ ) {
+		bucketOffsets[b + 1] += bucketOffsets[b];
+	}
+	for ( unsigned int i = 0; i < parameters.points; i++ ) {
+		cellOrder[bucketOffsets[cellBuckets[i]]++] = (int)i;
+	}
+}
+
+inline Line<float> Stippler::createEdgeLine( float x1, float y1, float x2, float y2 ) {
+	using std::abs;
+	using std::numeric_limits;
+
+	Line<float> l;
+
+	// if the floating point version of the line collapsed down to one
+	// point, then just ignore it all
+	if (abs(x1 - x2) < numeric_limits<float>::epsilon() && abs(y1 - y2) < numeric_limits<float>::epsilon()) {
+		l.a = .0f;
+		l.b = .0f;
+		l.c = .0f;
+
+		return l;
+	}
+
+	// the left of the edge, which is the inside of a counter-clockwise
+	// ring, is where the line is negative
+	l.a = -(y1 - y2);
+	l.b = x1 - x2;
+	l.c = (y1 - y2) * x1 - (x1 - x2) * y1;
+
+	return l;
+}
+
+inline Line<float> Stippler::createClipLine( float insideX, float insideY, float x1, float y1, float x2, float y2 ) {
+	Line<float> l = createEdgeLine( x1, y1, x2, y2 );
+
+	// make sure the known inside point falls on the correct side of the clipping plane
+	if ( insideX * l.a + insideY * l.b + l.c > 0.0f ) {
+		l.a *= -1;
+		l.b *= -1;
+		l.c *= -1;
+	}
+
+	return l;
+}
+
+template< class Sampler, class Real >
+Stippler::CentroidKernel Stippler::selectCentroidKernel() {
+	// adaptive densities vary from cell to cell, so only the fixed ones get
+	// kernels of their own
+	switch ( parameters.cellSamples > 0 ? 0 : parameters.subpixels ) {
+	case 1: return selectCentroidModes< 1, Sampler, Real >();
+	case 2: return selectCentroidModes< 2, Sampler, Real >();
+	case 3: return selectCentroidModes< 3, Sampler, Real >();
+	case 4: return selectCentroidModes< 4, Sampler, Real >();
+	case 5: return selectCentroidModes< 5, Sampler, Real >();
+	case 6: return selectCentroidModes< 6, Sampler, Real >();
+	case 7: return selectCentroidModes< 7, Sampler, Real >();
+	case 8: return selectCentroidModes< 8, Sampler, Real >();
+	default: return selectCentroidModes< 0, Sampler, Real >();
+	}
+}
+
+// the centroid method, closed cells, the vector kernel and the intensity
+// cache stay runtime branches. each is fixed for the whole run, so they are
+// always predicted, and all but the cache are taken once per cell or per row
+// rather than per sample. making them template parameters as well would
+// multiply the 216 kernels by another 32 for no measurable gain.
+template< int Subpixels, class Sampler, class Real >
+Stippler::CentroidKernel Stippler::selectCentroidModes() {
+	if ( parameters.noOverlap ) {
+		return parameters.fixedRadius ? &Stippler::calculateCellCentroid< Subpixels, Sampler, Real, true, false > : &Stippler::calculateCellCentroid< Subpixels, Sampler, Real, true, true >;
+	} else {
+		return parameters.fixedRadius ? &Stippler::calculateCellCentroid< Subpixels, Sampler, Real, false, false > : &Stippler::calculateCellCentroid< Subpixels, Sampler, Real, false, true >;
+	}
+}
+
+template< int Subpixels, class Sampler, class Real, bool NoOverlap, bool NeedRadius >
+std::pair< Point<float>, float > Stippler::calculateCellCentroid( Point<float> &inside, EdgeIterator first, EdgeIterator last, const int *neighbours, unsigned int &samples ) {
+	using std::make_pair;
+	using std::numeric_limits;
+	using std::vector;
+	using std::abs;
+	using std::sqrt;
+	using std::pow;
+	using std::ceil;
+	using std::min;
+	using std::max;
+
+	vector< Line<float> > &clipLines = cellClipLines[threadIndex()];
+	Extents<float> extent = getCellExtents(first, last);
+
+	clipLines.clear();
+
+	// compute the clip lines. the sides of a closed cell run counter-clockwise
+	// so there is no need to work out which way they face.
+	for ( EdgeIterator value_iter = first; value_iter != last; ++value_iter ) {
+		Line<float> l = parameters.closedCells ?
+			createEdgeLine( value_iter->begin.x, value_iter->begin.y, value_iter->end.x, value_iter->end.y ) :
+			createClipLine( inside.x, inside.y, 
+				value_iter->begin.x, value_iter->begin.y,
+				value_iter->end.x, value_iter->end.y );
+	
+		if (l.a < numeric_limits<float>::epsilon() && abs(l.b) < numeric_limits<float>::epsilon()) {
+			continue;
+		}
+
+		clipLines.push_back(l);
+	}
+
+	// spread about the same number of samples over the bounding box of every
+	// cell, so large cells are sampled more coarsely than small ones
+	float density = Subpixels > 0 ? (float)Subpixels : (float)parameters.subpixels;
+	if ( Subpixels == 0 && parameters.cellSamples > 0 ) {
+		float area = max( ceil( extent.maxX - extent.minX ) * ceil( extent.maxY - extent.minY ), 1.0f );
+		density = min( max( sqrt( parameters.cellSamples / area ), parameters.minSubpixels ), parameters.maxSubpixels );
+	}
+
+	Moments<Real> moments;
+	vector< Point<float> > &polygon = cellPolygons[threadIndex()];
+	switch ( parameters.centroidMethod ) {
+	case CENTROID_PREFIX_SUM:
+		if ( parameters.closedCells ) {
+			polygon.clear();
+			for ( EdgeIterator value_iter = first; value_iter != last; ++value_iter ) {
+				polygon.push_back( value_iter->begin );
+			}
+		} else {
+			createCellPolygon( clipLines, extent, polygon, cellClippedPolygons[threadIndex()] );
+		}
+		moments = integrateCellEdges< Subpixels, Real >( polygon, density, samples );
+		break;
+	case CENTROID_SCANLINE:
+		moments = integrateCellSpans< Subpixels, Sampler, Real >( clipLines, extent, density, samples );
+		break;
+	case CENTROID_QUASI_RANDOM:
+		moments = integrateCellQuasiRandom< Sampler, Real >( clipLines, extent, density, samples );
+		break;
+	default:
+		moments = integrateCellSamples< Subpixels, Sampler, Real >( clipLines, extent, density, samples );
+		break;
+	}
+
+	Point<float> pt;
+	if (moments.areaDensity > numeric_limits<float>::epsilon()) {
+		pt.x = (float)( moments.xSum / moments.areaDensity );
+		pt.y = (float)( moments.ySum / moments.areaDensity );
+	} else {
+		// if for some reason, the cell is completely white, then the centroid does not move
+		pt.x = inside.x;
+		pt.y = inside.y;
+	}
+
+	if ( !NeedRadius ) {
+		return make_pair( pt, 0.0f );
+	}
+
+	float closest = numeric_limits<float>::max(),
+		  farthest = numeric_limits<float>::min(),
+		  distance;
+	float x0 = pt.x, y0 = pt.y,
+	      x1, x2, y1, y2;
+
+	for ( EdgeIterator value_iter = first; value_iter != last; ++value_iter, ++neighbours ) {
+		// the image border is not shared with another stipple
+		if ( *neighbours < 0 ) {
+			continue;
+		}
+
+		x1 = value_iter->begin.x; x2 = value_iter->end.x;
+		y1 = value_iter->begin.y; y2 = value_iter->end.y;
+
+		distance = abs( ( x2 - x1 ) * ( y1 - y0 ) - ( x1 - x0 ) * ( y2 - y1 ) ) / sqrt( pow( x2 - x1, 2.0f ) + pow( y2 - y1, 2.0f ) );
+		if ( NoOverlap && closest > distance ) {
+			closest = distance;
+		}
+		if ( !NoOverlap && farthest < distance ) {
+			farthest = distance;
+		}
+	}
+
+	float radius = NoOverlap ? closest : farthest;
+	radius *= (float)( moments.areaDensity / moments.maxAreaDensity );
+
+	return make_pair( pt, radius );
+}
+
+template< int Subpixels, class Sampler, class Real >
+Moments<Real> Stippler::integrateCellSamples( std::vector< Line<float> > &clipLines, Extents<float> &extent, float density, unsigned int &samples ) {
+	using std::vector;
+	using std::ceil;
+
+	unsigned int x, y;
+
+	float xDiff = ( extent.maxX - extent.minX );
+	float yDiff = ( extent.maxY - extent.minY );
+
+	unsigned int tileWidth = Subpixels > 0 ? (unsigned int)ceil(xDiff) * Subpixels : (unsigned int)ceil(ceil(xDiff) * density);
+	unsigned int tileHeight = Subpixels > 0 ? (unsigned int)ceil(yDiff) * Subpixels : (unsigned int)ceil(ceil(yDiff) * density);
+	samples = tileWidth * tileHeight;
+	const unsigned int unroll = Subpixels > 0 ? Subpixels : 1;
+
+	float xStep = xDiff / (float)tileWidth;
+	float yStep = yDiff / (float)tileHeight;
+
+	float spotDensity;
+	Moments<Real> moments = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	float xCurrent;
+	float yCurrent;
+
+	bool cached = image.getSupersampledDensity() > 0;
+	SampleRow row = { image.getIntensityMap(), image.getWidth(), clipLines.empty() ? NULL : &clipLines[0], clipLines.size(),
+		extent.minX, 0.0f, xStep, (int)tileWidth, parameters.sampler };
+
+	for ( y = 0, yCurrent = extent.minY; y < tileHeight; ++y, yCurrent += yStep ) {
+		if ( sampleKernel ) {
+			row.y = yCurrent;
+			sampleRow( sampleKernel, row, moments );
+			continue;
+		}
+
+		// at a fixed density the row is a whole number of pixels, so the
+		// samples of one pixel go in an inner loop of constant length
+		for ( x = 0, xCurrent = extent.minX; x < tileWidth; x += unroll ) {
+			for ( unsigned int k = 0; k < unroll; ++k, xCurrent += xStep ) {
+				// a point is outside of the polygon if it is outside of all clipping planes
+				bool outside = false;
+				for ( vector< Line<float> >::iterator iter = clipLines.begin(); iter != clipLines.end(); iter++ ) {
+					if ( xCurrent * iter->a + yCurrent * iter->b + iter->c >= 0.0f ) {
+						outside = true;
+						break;
+					}
+				}
+
+				if (!outside) {
+					spotDensity = cached ? image.getSupersampledIntensity(xCurrent, yCurrent) : image.sample< Sampler >(xCurrent, yCurrent);
+
+					moments.areaDensity += spotDensity;
+					moments.maxAreaDensity += 255.0f;
+					moments.xSum += (Real)spotDensity * xCurrent;
+					moments.ySum += (Real)spotDensity * yCurrent;
+				}
+			}
+		}
+	}
+
+	return moments;
+}
+
+template< int Subpixels, class Sampler, class Real >
+Moments<Real> Stippler::integrateCellSpans( std::vector< Line<float> > &clipLines, Extents<float> &extent, float density, unsigned int &samples ) {
+	using std::vector;
+	using std::ceil;
+	using std::floor;
+	using std::min;
+	using std::max;
+
+	float xDiff = ( extent.maxX - extent.minX );
+	float yDiff = ( extent.maxY - extent.minY );
+
+	int tileWidth = Subpixels > 0 ? (int)ceil(xDiff) * Subpixels : (int)ceil(ceil(xDiff) * density);
+	int tileHeight = Subpixels > 0 ? (int)ceil(yDiff) * Subpixels : (int)ceil(ceil(yDiff) * density);
+
+	float xStep = xDiff / (float)tileWidth;
+	float yStep = yDiff / (float)tileHeight;
+
+	float spotDensity;
+	Moments<Real> moments = { 0.0f, 0.0f, 0.0f, 0.0f };
+	bool cached = image.getSupersampledDensity() > 0;
+
+	float yCurrent;
+	int y;
+
+	for ( y = 0, yCurrent = extent.minY; y < tileHeight; ++y, yCurrent += yStep ) {
+		// the cell is convex, so it covers one span of every row, bounded by
+		// the clip lines which are crossed going left to right
+		float low = extent.minX - xStep, high = extent.maxX + xStep;
+
+		for ( vector< Line<float> >::iterator iter = clipLines.begin(); iter != clipLines.end() && low < high; iter++ ) {
+			float offset = yCurrent * iter->b + iter->c;
+
+			if ( iter->a > 0.0f ) {
+				high = min( high, -offset / iter->a );
+			} else if ( iter->a < 0.0f ) {
+				low = max( low, -offset / iter->a );
+			} else if ( offset >= 0.0f ) {
+				high = low;
+			}
+		}
+
+		if ( low >= high ) {
+			continue;
+		}
+
+		int first = max( (int)floor( ( low - extent.minX ) / xStep ), 0 );
+		int last = min( (int)ceil( ( high - extent.minX ) / xStep ), tileWidth - 1 );
+
+		// the divisions round, so settle the samples at either end of the span
+		// with the same test the sampled integrator makes
+		while ( first <= last && !isInsideCell( clipLines, extent.minX + first * xStep, yCurrent ) ) {
+			first++;
+		}
+		while ( last >= first && !isInsideCell( clipLines, extent.minX + last * xStep, yCurrent ) ) {
+			last--;
+		}
+
+		samples += last - first + 1;
+
+		if ( sampleKernel ) {
+			SampleRow row = { image.getIntensityMap(), image.getWidth(), NULL, 0,
+				extent.minX + first * xStep, yCurrent, xStep, last - first + 1, parameters.sampler };
+			sampleRow( sampleKernel, row, moments );
+			continue;
+		}
+
+		for ( int x = first; x <= last; x++ ) {
+			float xCurrent = extent.minX + x * xStep;
+
+			spotDensity = cached ? image.getSupersampledIntensity(xCurrent, yCurrent) : image.sample< Sampler >(xCurrent, yCurrent);
+
+			moments.areaDensity += spotDensity;
+			moments.maxAreaDensity += 255.0f;
+			moments.xSum += (Real)spotDensity * xCurrent;
+			moments.ySum += (Real)spotDensity * yCurrent;
+		}
+	}
+
+	return moments;
+}
+
+template< class Sampler, class Real >
+Moments<Real> Stippler::integrateCellQuasiRandom( std::vector< Line<float> > &clipLines, Extents<float> &extent, float density, unsigned int &samples ) {
+	using std::ceil;
+	using std::min;
+	using std::max;
+
+	// the R2 sequence steps by the powers of 1 / g, g being the plastic number
+	// (g^3 = g + 1), which spreads the samples over the bounding box with less
+	// discrepancy than any regular grid or random jitter
+	const double g = 1.32471795724474602596;
+	const double xAlpha = 1.0 / g, yAlpha = 1.0 / ( g * g );
+	const unsigned int firstCheck = 32;
+
+	float xDiff = ( extent.maxX - extent.minX );
+	float yDiff = ( extent.maxY - extent.minY );
+
+	// never take more samples than the grid would, and never fewer than one
+	// for every pixel of the bounding box, so that a small dark spot in an
+	// otherwise white cell is found before the error is estimated at all
+	unsigned int limit = max( (unsigned int)ceil(ceil(xDiff) * density) * (unsigned int)ceil(ceil(yDiff) * density), firstCheck );
+	unsigned int minimum = min( max( (unsigned int)ceil(xDiff) * (unsigned int)ceil(yDiff), firstCheck ), limit );
+
+	float spotDensity;
+	Moments<Real> moments = { 0.0f, 0.0f, 0.0f, 0.0f };
+	bool cached = image.getSupersampledDensity() > 0;
+
+	// the samples are dealt out in turn to a few interleaved estimates, each
+	// a shifted R2 sequence of its own. the spread of their centroids gives
+	// the standard error of their mean, which overstates the error of the
+	// whole sequence since together they cover the box more evenly than
+	// independent estimates would.
+	const int estimates = 4;
+	Real estimateMass[estimates] = { 0.0f }, estimateX[estimates] = { 0.0f }, estimateY[estimates] = { 0.0f };
+	unsigned int check = minimum;
+
+	double u = 0.5, v = 0.5;
+	for ( samples = 0; samples < limit; ) {
+		float xCurrent = extent.minX + (float)u * xDiff;
+		float yCurrent = extent.minY + (float)v * yDiff;
+		int estimate = samples % estimates;
+
+		if ( isInsideCell( clipLines, xCurrent, yCurrent ) ) {
+			spotDensity = cached ? image.getSupersampledIntensity(xCurrent, yCurrent) : image.sample< Sampler >(xCurrent, yCurrent);
+
+			moments.maxAreaDensity += 255.0f;
+			estimateMass[estimate] += spotDensity;
+			estimateX[estimate] += (Real)spotDensity * xCurrent;
+			estimateY[estimate] += (Real)spotDensity * yCurrent;
+		}
+
+		u += xAlpha; if ( u >= 1.0 ) u -= 1.0;
+		v += yAlpha; if ( v >= 1.0 ) v -= 1.0;
+
+		if ( ++samples < check ) {
+			continue;
+		}
+		check *= 2;
+
+		// an estimate which saw nothing but white says nothing about the
+		// error yet
+		float xs[estimates], ys[estimates], x = 0.0f, y = 0.0f;
+		int e = 0;
+		for ( ; e < estimates && estimateMass[e] > 0.0f; e++ ) {
+			xs[e] = (float)( estimateX[e] / estimateMass[e] );
+			ys[e] = (float)( estimateY[e] / estimateMass[e] );
+			x += xs[e] / estimates;
+			y += ys[e] / estimates;
+		}
+		if ( e < estimates ) {
+			continue;
+		}
+
+		float variance = 0.0f;
+		for ( e = 0; e < estimates; e++ ) {
+			variance += ( xs[e] - x ) * ( xs[e] - x ) + ( ys[e] - y ) * ( ys[e] - y );
+		}
+		if ( variance / ( estimates * ( estimates - 1 ) ) < parameters.centroidTolerance * parameters.centroidTolerance ) {
+			break;
+		}
+	}
+
+	for ( int e = 0; e < estimates; e++ ) {
+		moments.areaDensity += estimateMass[e];
+		moments.xSum += estimateX[e];
+		moments.ySum += estimateY[e];
+	}
+
+	return moments;
+}
+
+template< int Subpixels, class Real >
+Moments<Real> Stippler::integrateCellEdges( std::vector< Point<float> > &polygon, float density, unsigned int &samples ) {
+	using std::ceil;
+
+	// by Green's theorem the integral of f over the cell is the integral of
+	// F dy around its boundary, where F is the integral of f along a row. the
+	// bitmap tabulates F for f = I and f = x * I, and y * I needs no table of
+	// its own since y is constant along a row.
+
+	float step = 1.0f / ( Subpixels > 0 ? (float)Subpixels : density );
+	double area = 0.0, mass = 0.0, xMoment = 0.0, yMoment = 0.0;
+
+	for ( size_t i = 0; i < polygon.size(); i++ ) {
+		Point<float> &p = polygon[i], &q = polygon[(i + 1) % polygon.size()];
+
+		if ( p.y == q.y ) {
+			continue;
+		}
+
+		// every row is counted once on each side of the (convex) cell by
+		// treating the edge as half open in y
+		float sign = q.y > p.y ? 1.0f : -1.0f;
+		float yLow = q.y > p.y ? p.y : q.y, yHigh = q.y > p.y ? q.y : p.y;
+		float slope = (q.x - p.x) / (q.y - p.y);
+
+		// the division can round either way, so settle the first row with the
+		// same comparison as the last one
+		int row = (int)ceil(yLow / step);
+		while ( (float)row * step < yLow ) {
+			row++;
+		}
+		while ( row > 0 && (float)(row - 1) * step >= yLow ) {
+			row--;
+		}
+
+		for ( ; (float)row * step < yHigh; row++ ) {
+			float y = (float)row * step;
+			float x = p.x + (y - p.y) * slope;
+
+			double rowMass, rowMoment;
+			image.getRowIntegrals( x, y, rowMass, rowMoment );
+			samples++;
+
+			area += sign * x;
+			mass += sign * rowMass;
+			xMoment += sign * rowMoment;
+			yMoment += sign * y * rowMass;
+		}
+	}
+
+	Moments<Real> moments;
+	moments.areaDensity = (Real)(mass * step);
+	moments.maxAreaDensity = (Real)(area * step * 255.0);
+	moments.xSum = (Real)(xMoment * step);
+	moments.ySum = (Real)(yMoment * step);
+
+	return moments;
+}
+
+void Stippler::createCellPolygon( std::vector< Line<float> > &clipLines, Extents<float> &extent,
+	std::vector< Point<float> > &polygon, std::vector< Point<float> > &clipped ) {
+	using std::vector;
+
+	// clip the bounding box of the cell against every clip line in turn
+	Point<float> corner;
+
+	polygon.clear();
+
+	corner.x = extent.minX; corner.y = extent.minY; polygon.push_back( corner );
+	corner.x = extent.maxX; corner.y = extent.minY; polygon.push_back( corner );
+	corner.x = extent.maxX; corner.y = extent.maxY; polygon.push_back( corner );
+	corner.x = extent.minX; corner.y = extent.maxY; polygon.push_back( corner );
+
+	for ( vector< Line<float> >::iterator iter = clipLines.begin(); iter != clipLines.end() && !polygon.empty(); iter++ ) {
+		clipped.clear();
+
+		for ( size_t i = 0; i < polygon.size(); i++ ) {
+			Point<float> &p = polygon[i], &q = polygon[(i + 1) % polygon.size()];
+			float dP = p.x * iter->a + p.y * iter->b + iter->c;
+			float dQ = q.x * iter->a + q.y * iter->b + iter->c;
+
+			if ( dP < 0.0f ) {
+				clipped.push_back( p );
+			}
+			if ( ( dP < 0.0f ) != ( dQ < 0.0f ) ) {
+				Point<float> intersection;
+				float t = dP / (dP - dQ);
+
+				intersection.x = p.x + (q.x - p.x) * t;
+				intersection.y = p.y + (q.y - p.y) * t;
+				clipped.push_back( intersection );
+			}
+		}
+
+		polygon.swap( clipped );
+	}
+}
+
+Extents<float> Stippler::getCellExtents( EdgeIterator first, EdgeIterator last ) {
+	using std::numeric_limits;
+
+	Extents<float> extent;
+
+	extent.minX = extent.minY = numeric_limits<float>::max();
+	extent.maxX = extent.maxY = numeric_limits<float>::min();
+
+	for ( EdgeIterator value_iter = first; value_iter != last; ++value_iter ) {
+		if ( value_iter->begin.x < extent.minX ) extent.minX = value_iter->begin.x;
+		if ( value_iter->end.x < extent.minX ) extent.minX = value_iter->end.x;
+		if ( value_iter->begin.y < extent.minY ) extent.minY = value_iter->begin.y;
+		if ( value_iter->end.y < extent.minY ) extent.minY = value_iter->end.y;
+
+		if ( value_iter->begin.x > extent.maxX ) extent.maxX = value_iter->begin.x;
+		if ( value_iter->end.x > extent.maxX ) extent.maxX = value_iter->end.x;
+		if ( value_iter->begin.y > extent.maxY ) extent.maxY = value_iter->begin.y;
+		if ( value_iter->end.y > extent.maxY ) extent.maxY = value_iter->end.y;
+	}
+
+	return extent;
+}
+
+bool operator==(Point<float> const& p1, Point<float> const& p2)
+{
+	using std::abs;
+	using std::numeric_limits;
+
+	return abs( p1.x - p2.x ) < numeric_limits<float>::epsilon() && 
+		abs( p1.y - p2.y ) < numeric_limits<float>::epsilon();
+}
@@ -1,75 +1,145 @@
-/* The MIT License
-
-Copyright (c) 2011 Sahab Yazdani
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-THE SOFTWARE.
-*/
-
-#ifndef STIPPLER_H
-#define STIPPLER_H
-
-#ifdef _WIN32
-#ifdef STIPPLER_LIBRARY
-#define STIPPLER_METHOD __declspec(dllexport)
-#else
-#define STIPPLER_METHOD __declspec(dllimport)
-#endif
-#else
-#define STIPPLER_METHOD
-#endif
-
-#ifdef __cplusplus
-extern "C" {
-#endif 
-
-typedef void * STIPPLER_HANDLE;
-
-struct StipplingParameters {
-	char *inputFile;
-	unsigned int points;
-	bool noOverlap;
-	unsigned int subpixels;
-};
-
-struct StipplePoint {
-	float x;
-	float y;
-	float radius;
-	unsigned char r;
-	unsigned char g;
-	unsigned char b;
-};
-
-STIPPLER_METHOD void stippler_lib_init();
-STIPPLER_METHOD void stippler_lib_destroy();
-
-STIPPLER_METHOD STIPPLER_HANDLE create_stippler( StipplingParameters *parameters );
-STIPPLER_METHOD void destroy_stippler( STIPPLER_HANDLE handle );
-
-STIPPLER_METHOD void stippler_distribute( STIPPLER_HANDLE handle );
-STIPPLER_METHOD float stippler_getAverageDisplacement( STIPPLER_HANDLE handle );
-STIPPLER_METHOD void stippler_getStipples( STIPPLER_HANDLE handle, StipplePoint *dst );
-
-STIPPLER_METHOD const char *stippler_getLastError();
-
-#ifdef __cplusplus
-}
-#endif
-
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef STIPPLER_H
+#define STIPPLER_H
+
+#ifdef _WIN32
+#ifdef STIPPLER_LIBRARY
+#define STIPPLER_METHOD __declspec(dllexport)
+#else
+#define STIPPLER_METHOD __declspec(dllimport)
+#endif
+#else
+#define STIPPLER_METHOD
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif 
+
+typedef void * STIPPLER_HANDLE;
+
+#define STIPPLER_MAX_THREADS 64
+
+enum CentroidMethod {
+	CENTROID_SAMPLED,		// sample every cell on a subpixel grid
+	CENTROID_PREFIX_SUM,	// integrate row prefix sums along the cell edges
+	CENTROID_SCANLINE,		// sample the same grid, only along the span of the cell in each row
+	CENTROID_QUASI_RANDOM	// sample a low discrepancy sequence until the centroid settles
+};
+
+enum IntensitySampler {
+	SAMPLER_BILINEAR,		// interpolate between the four pixels around every sample
+	SAMPLER_NEAREST,		// read the nearest pixel
+	SAMPLER_BOX				// average the four pixels around every sample
+};
+
+enum AccumulatorType {
+	ACCUMULATOR_FLOAT,		// sum the moments of a cell in single precision
+	ACCUMULATOR_DOUBLE		// sum them in double precision, for cells of very many samples
+};
+
+enum VoronoiEngine {
+	VORONOI_FORTUNE,		// Fortune's sweep over the stipple points
+	VORONOI_DELAUNAY		// dual of an incremental Delaunay triangulation
+};
+
+enum SweepBeachLine {
+	SWEEP_BEACH_LINE_HASHED,	// hash buckets over x, fastest for evenly spread stipples
+	SWEEP_BEACH_LINE_TREAP		// balanced tree, for strongly clustered stipples
+};
+
+enum SweepEventQueue {
+	SWEEP_EVENT_QUEUE_BUCKETED,	// buckets over y, fastest for evenly spread stipples
+	SWEEP_EVENT_QUEUE_HEAP		// binary heap, for strongly clustered stipples
+};
+
+struct StipplingParameters {
+	char *inputFile;
+	unsigned int points;
+	bool noOverlap;
+	unsigned int subpixels;
+	unsigned int cellSamples;	// samples to spend on every cell, 0 to sample every cell at the subpixel density
+	float minSubpixels;			// bounds of the subpixel density picked for each cell
+	float maxSubpixels;
+	CentroidMethod centroidMethod;
+	IntensitySampler sampler;
+	AccumulatorType accumulator;
+	float centroidTolerance;	// the quasi random estimator stops once the standard error of its centroid is below this
+	bool noSimd;				// sample cells with scalar code even where the processor has vector kernels, which sum in another order
+	unsigned int intensityCache;	// megabytes of precomputed subpixel intensities, 0 to interpolate every sample
+	VoronoiEngine engine;
+	unsigned int sweepTiles;	// tiles along each side for a parallel sweep
+	SweepBeachLine beachLine;
+	SweepEventQueue eventQueue;
+	float rebuildTolerance;		// sites which moved less than this keep their old cells
+	float activeTolerance;		// cells whose site and neighbours moved less than this keep their centroids
+	unsigned int reorderInterval;	// iterations between Hilbert curve reorderings of the sites, 0 for never
+	bool closedCells;			// close every cell along the image border into a counter-clockwise ring
+	bool pipelinedSweep;		// integrate the cells of a full sweep as it completes them
+	bool fixedRadius;			// every stipple is drawn the same size, so the radii are left at 0
+};
+
+struct StipplingStatistics {
+	unsigned long diagramMemory;	// bytes used to build the last Voronoi diagram
+	float diagramTime;				// seconds spent building the last Voronoi diagram
+	float sortTime;					// of which this many were spent sorting the sites
+	unsigned int rebuiltCells;		// cells rebuilt for the last Voronoi diagram
+	unsigned int activeCells;		// cells whose centroids were integrated in the last iteration
+	unsigned long samples;			// samples taken to integrate them
+	unsigned int threads;			// threads which integrated them, at most STIPPLER_MAX_THREADS
+	float busyTime[STIPPLER_MAX_THREADS];	// seconds each thread spent integrating cells
+	float idleTime[STIPPLER_MAX_THREADS];	// and waiting for the other threads to finish
+	unsigned long intensityCacheMemory;	// bytes of precomputed subpixel intensities
+	unsigned int intensityCacheDensity;	// precomputed intensities along each side of a pixel, 0 for none
+	unsigned int localRebuilds;		// diagrams so far which only rebuilt the cells around moved stipples
+};
+
+struct StipplePoint {
+	float x;
+	float y;
+	float radius;
+	unsigned char r;
+	unsigned char g;
+	unsigned char b;
+};
+
+STIPPLER_METHOD void stippler_lib_init();
+STIPPLER_METHOD void stippler_lib_destroy();
+
+STIPPLER_METHOD STIPPLER_HANDLE create_stippler( StipplingParameters *parameters );
+STIPPLER_METHOD void destroy_stippler( STIPPLER_HANDLE handle );
+
+STIPPLER_METHOD void stippler_distribute( STIPPLER_HANDLE handle );
+STIPPLER_METHOD float stippler_getAverageDisplacement( STIPPLER_HANDLE handle );
+STIPPLER_METHOD void stippler_getStipples( STIPPLER_HANDLE handle, StipplePoint *dst );
+STIPPLER_METHOD void stippler_getStatistics( STIPPLER_HANDLE handle, StipplingStatistics *dst );
+
+STIPPLER_METHOD const char *stippler_getLastError();
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // STIPPLER_H
\ No newline at end of file
@@ -1,78 +1,191 @@
-/* The MIT License
-
-Copyright (c) 2011 Sahab Yazdani
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-THE SOFTWARE.
-*/
-
-#ifndef STIPPLER_IMPL_H
-#define STIPPLER_IMPL_H
-
-#ifdef _WIN32
-#define NOMINMAX
-#include <windows.h>
-#endif // _WIN32
-
-#include <string>
-#include <vector>
-
-#include <boost/unordered_map.hpp>
-
-#include "stippler.h"
-#include "istippler.h"
-#include "utility.h"
-#include "bitmap.h"
-
-class Stippler : public IStippler {
-protected:
-	typedef std::vector< Edge< float > > EdgeList;
-	typedef boost::unordered_map< Point < float >, EdgeList > EdgeMap;
-public:
-	Stippler( const StipplingParameters &parameters );
-	~Stippler();
-
-	void distribute();
-	float getAverageDisplacement();
-	void getStipples( StipplePoint *dst );
-protected:
-	void createInitialDistribution();
-	void createVoronoiDiagram();
-
-	Extents<float> getCellExtents( EdgeList &edgeList );
-
-	void redistributeStipples();
-
-	std::pair< Point<float>, float > calculateCellCentroid( Point<float> &inside, EdgeList &edgeList );
-	Line<float> createClipLine( float insideX, float insideY, float x1, float y1, float x2, float y2 );
-protected:
-	EdgeMap edges;
-
-	float *vertsX, *vertsY;
-	float *radii;
-	float displacement;
-
-	Bitmap image;
-
-	const StipplingParameters &parameters;
-};
-
-bool operator==(Point<float> const& p1, Point<float> const& p2);
-std::size_t hash_value(Point<float> const& p);
-
-#endif // STIPPLER_IMPL_H
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef STIPPLER_IMPL_H
+#define STIPPLER_IMPL_H
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif // _WIN32
+
+#include <string>
+#include <vector>
+
+#include "stippler.h"
+#include "istippler.h"
+#include "utility.h"
+#include "bitmap.h"
+#include "sampling.h"
+
+class VoronoiDiagramGenerator;
+class DelaunayTriangulation;
+
+class Stippler : public IStippler {
+protected:
+	typedef const Edge< float > * EdgeIterator;
+
+	// an edge of the cell of one site, shared with the cell of its neighbour
+	struct CellEdge {
+		int site;
+		int neighbour;
+		Edge< float > edge;
+	};
+public:
+	Stippler( const StipplingParameters &parameters );
+	~Stippler();
+
+	void distribute();
+	float getAverageDisplacement();
+	void getStipples( StipplePoint *dst );
+	void getStatistics( StipplingStatistics *dst );
+protected:
+	void createInitialDistribution();
+	void reorderSites();
+	void createVoronoiDiagram();
+	void createTiledVoronoiDiagram();
+	bool createDelaunayDiagram();
+	int getTile( float x, float y );
+
+	bool findMovedSites();
+	void updateVoronoiDiagram();
+	void reserveLocalRebuild();
+	void createSiteGrid();
+	void createLocalCell( int site, std::vector< CellEdge > &output );
+	void createCellScratch();
+
+	Extents<float> getCellExtents( EdgeIterator first, EdgeIterator last );
+
+	void redistributeStipples();
+	void redistributeSweptStipples();
+	static void completeSweptCell( void *context, int site );
+	void prepareRedistribution();
+	bool redistributeCell( int site, EdgeIterator first, EdgeIterator last, const int *neighbours, unsigned long &samples );
+	void finishRedistribution( float totalDisplacement, int cells, int active, unsigned long samples );
+	void orderCells();
+
+	// the centroid and radius of a cell, specialised on the subpixel density
+	// (0 for any other or an adaptive one), the way intensities are sampled,
+	// the type its moments are summed in, the overlap mode and whether the
+	// radius is drawn at all
+	typedef std::pair< Point<float>, float > (Stippler::*CentroidKernel)( Point<float> &inside, EdgeIterator first, EdgeIterator last, const int *neighbours, unsigned int &samples );
+	template< class Sampler, class Real > CentroidKernel selectCentroidKernel();
+	template< int Subpixels, class Sampler, class Real > CentroidKernel selectCentroidModes();
+	template< int Subpixels, class Sampler, class Real, bool NoOverlap, bool NeedRadius >
+	std::pair< Point<float>, float > calculateCellCentroid( Point<float> &inside, EdgeIterator first, EdgeIterator last, const int *neighbours, unsigned int &samples );
+	Line<float> createEdgeLine( float x1, float y1, float x2, float y2 );
+	Line<float> createClipLine( float insideX, float insideY, float x1, float y1, float x2, float y2 );
+
+	template< int Subpixels, class Sampler, class Real > Moments<Real> integrateCellSamples( std::vector< Line<float> > &clipLines, Extents<float> &extent, float density, unsigned int &samples );
+	template< int Subpixels, class Sampler, class Real > Moments<Real> integrateCellSpans( std::vector< Line<float> > &clipLines, Extents<float> &extent, float density, unsigned int &samples );
+	template< class Sampler, class Real > Moments<Real> integrateCellQuasiRandom( std::vector< Line<float> > &clipLines, Extents<float> &extent, float density, unsigned int &samples );
+	template< int Subpixels, class Real > Moments<Real> integrateCellEdges( std::vector< Point<float> > &polygon, float density, unsigned int &samples );
+	void createCellPolygon( std::vector< Line<float> > &clipLines, Extents<float> &extent,
+		std::vector< Point<float> > &polygon, std::vector< Point<float> > &clipped );
+protected:
+	// the edges of every cell, indexed by site in compressed sparse row form:
+	// the edges of site i are cellEdges[cellOffsets[i]] to cellEdges[cellOffsets[i + 1]]
+	// and the sites on the other side of them are in cellNeighbours, -1 for
+	// the image border of closed cells
+	std::vector< int > cellOffsets, cellFill, cellNeighbours;
+	std::vector< Edge<float> > cellEdges;
+
+	// generators are kept between iterations so their memory is reused
+	VoronoiDiagramGenerator *generator, *tileGenerators;
+	DelaunayTriangulation *triangulation;
+
+	// sites bucketed by tile, the sites each tile sweeps over along with its
+	// halo, the edges of the cells each tile owns, and the most of either
+	// that any tile has needed
+	std::vector< int > tileOffsets, tileSites;
+	std::vector< std::vector< float > > tileX, tileY;
+	std::vector< std::vector< int > > tileIndices;
+	std::vector< std::vector< CellEdge > > tileEdges;
+	size_t tileHaloCapacity, tileEdgeCapacity;
+
+	// the site positions the current diagram was built from, the sites which
+	// moved further than the rebuild tolerance since, the cells to redo and
+	// the most edges a rebuild of them has needed
+	std::vector< float > diagramX, diagramY;
+	std::vector< int > movedSites, updatedSites;
+	std::vector< char > updatedCells;
+	std::vector< std::vector< CellEdge > > updatedEdges;
+	size_t localEdgeCapacity;
+	std::vector< int > nextOffsets, nextNeighbours;
+	std::vector< Edge<float> > nextEdges;
+
+	// how far every site moved in the last two iterations, and the sites
+	// whose cells have to be integrated again regardless
+	std::vector< float > siteMoves, nextMoves;
+	std::vector< char > activeSites;
+
+	// the cells of a pipelined sweep in the order it completed them, laid
+	// out like the cells of the diagram. the buffers are sized up front, so
+	// the threads integrating the first sweptCells of them can read them
+	// while the sweep appends the rest.
+	std::vector< int > sweptSites, sweptOffsets, sweptNeighbours;
+	std::vector< Edge<float> > sweptEdges;
+	int sweptCells, sweptClaims, sweptDone;
+
+	// the samples every cell took the last time it was integrated, and the
+	// cells in order of their expected cost, largest first
+	std::vector< float > cellCosts;
+	std::vector< int > cellOrder, cellBuckets;
+
+	// per thread clip lines and polygons of the cell being built or
+	// integrated, and what lies across each side of the polygons
+	std::vector< std::vector< Line<float> > > cellClipLines;
+	std::vector< std::vector< Point<float> > > cellPolygons, cellClippedPolygons;
+	std::vector< std::vector< int > > cellLabels, cellClippedLabels;
+
+	// sites bucketed on a uniform grid for nearest neighbour queries
+	std::vector< int > gridOffsets, gridSites, siteBuckets;
+	int gridWidth, gridHeight;
+	float gridSize;
+
+	// the vector kernel cells are sampled with, NULL for the scalar loop
+	SampleRowKernel sampleKernel;
+	CentroidKernel centroidKernel;
+
+	float *vertsX, *vertsY;
+	float *radii;
+	float displacement;
+	unsigned int iterations;
+
+	// sites are stored in Hilbert curve order, and this maps them back to
+	// the order they are handed out in. the reordering sorts them with the
+	// buffers after it.
+	std::vector< int > siteIndices;
+	std::vector< std::pair< unsigned int, int > > reorderKeys;
+	std::vector< float > reorderValues;
+	std::vector< int > reorderIndices, reorderSiteIndices;
+	StipplingStatistics statistics;
+
+	Bitmap image;
+
+	const StipplingParameters &parameters;
+};
+
+bool operator==(Point<float> const& p1, Point<float> const& p2);
+
+#endif // STIPPLER_IMPL_H
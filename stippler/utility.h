@@ -1,54 +1,88 @@
-/* The MIT License
-
-Copyright (c) 2011 Sahab Yazdani
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-THE SOFTWARE.
-*/
-
-#ifndef UTILITY_H
-#define UTILITY_H
-
-template <class T>
-struct Point {
-	T x;
-	T y;
-};
-
-template <class T>
-struct Edge {
-	Point<T> begin;
-	Point<T> end;
-};
-
-template <class T>
-struct Extents {
-	T minX;
-	T minY;
-	T maxX;
-	T maxY;
-};
-
-template <class T>
-struct Line {
-	T a;
-	T b;
-	T c;
-};
-
-#endif // UTILITY_H
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef UTILITY_H
+#define UTILITY_H
+
+template <class T>
+struct Point {
+	T x;
+	T y;
+};
+
+template <class T>
+struct Edge {
+	Point<T> begin;
+	Point<T> end;
+};
+
+template <class T>
+struct Extents {
+	T minX;
+	T minY;
+	T maxX;
+	T maxY;
+};
+
+template <class T>
+struct Line {
+	T a;
+	T b;
+	T c;
+};
+
+// intensity weighted moments of a region. only ratios of the fields are
+// meaningful, so an integrator is free to leave out a constant area element.
+template <class T>
+struct Moments {
+	T areaDensity;
+	T maxAreaDensity;
+	T xSum;
+	T ySum;
+};
+
+// position of (x, y) along a Hilbert curve filling a 65536 square grid
+inline unsigned int hilbertIndex( unsigned int x, unsigned int y ) {
+	unsigned int d = 0;
+
+	for ( unsigned int s = 1 << 15; s > 0; s >>= 1 ) {
+		unsigned int rX = ( x & s ) > 0, rY = ( y & s ) > 0;
+		d += s * s * ( ( 3 * rX ) ^ rY );
+
+		// rotate the quadrant so the curve inside it runs the right way
+		if ( rY == 0 ) {
+			if ( rX == 1 ) {
+				x = s - 1 - ( x & ( s - 1 ) );
+				y = s - 1 - ( y & ( s - 1 ) );
+			}
+
+			unsigned int t = x;
+			x = y;
+			y = t;
+		}
+	}
+
+	return d;
+}
+
+#endif // UTILITY_H
@@ -0,0 +1,166 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// the stippler keeps every buffer it needs from one iteration to the next,
+// so once they have grown to size an iteration must not allocate. the
+// global operator new is replaced to count the allocations of each one.
+
+#include <cstdlib>
+#include <new>
+
+#include "testing.h"
+
+namespace {
+	// only ever changed between iterations, while no other thread runs
+	volatile bool counting = false;
+	volatile unsigned long allocations = 0;
+
+	void *allocate( size_t size ) {
+		if ( counting ) {
+			#pragma omp atomic
+			allocations++;
+		}
+
+		void *p = malloc( size > 0 ? size : 1 );
+		if ( p == NULL ) {
+			throw std::bad_alloc();
+		}
+		return p;
+	}
+}
+
+void *operator new( size_t size ) {
+	return allocate( size );
+}
+
+void *operator new[]( size_t size ) {
+	return allocate( size );
+}
+
+void operator delete( void *p ) throw() {
+	free( p );
+}
+
+void operator delete[]( void *p ) throw() {
+	free( p );
+}
+
+namespace {
+	// the first iteration grows the buffers, and the second tops up the
+	// ones which grow with the diagram
+	const unsigned int warmUp = 2;
+	const unsigned int checked = 4;
+
+	bool allocationFree( const char *name, StipplingParameters &parameters ) {
+		STIPPLER_HANDLE stippler = createTestStippler( parameters );
+		if ( stippler == NULL ) {
+			return false;
+		}
+
+		bool free = true, localRebuild = false;
+		for ( unsigned int iteration = 1; iteration <= warmUp + checked; iteration++ ) {
+			allocations = 0;
+			counting = iteration > warmUp;
+			stippler_distribute( stippler );
+			counting = false;
+
+			if ( allocations > 0 ) {
+				fprintf( stderr, "%s: iteration %u allocated %lu times\n", name, iteration, allocations );
+				free = false;
+			}
+
+			StipplingStatistics statistics;
+			stippler_getStatistics( stippler, &statistics );
+			localRebuild = localRebuild || ( iteration > warmUp && statistics.rebuiltCells < parameters.points );
+		}
+
+		// a rebuild tolerance only tests something once the cells are rebuilt locally
+		if ( parameters.rebuildTolerance > 0.0f && !localRebuild ) {
+			fprintf( stderr, "%s: no iteration rebuilt its cells locally\n", name );
+			free = false;
+		}
+
+		destroy_stippler( stippler );
+		return free;
+	}
+}
+
+int main() {
+	stippler_lib_init();
+	TestRun run( "allocations" );
+
+	const StipplingParameters defaults = testParameters( "corpus/phoenix.png", 2000, 2 );
+	StipplingParameters p = defaults;
+	run.check( allocationFree( "sampled", p ) );
+
+	p = defaults;
+	p.noSimd = true;
+	run.check( allocationFree( "sampled, scalar", p ) );
+
+	p = defaults;
+	p.centroidMethod = CENTROID_SCANLINE;
+	run.check( allocationFree( "scanline", p ) );
+
+	p = defaults;
+	p.centroidMethod = CENTROID_QUASI_RANDOM;
+	run.check( allocationFree( "quasi-random", p ) );
+
+	p = defaults;
+	p.centroidMethod = CENTROID_PREFIX_SUM;
+	run.check( allocationFree( "prefix sum", p ) );
+
+	p.closedCells = true;
+	run.check( allocationFree( "closed cells", p ) );
+
+	p = defaults;
+	p.engine = VORONOI_DELAUNAY;
+	run.check( allocationFree( "delaunay", p ) );
+
+	p = defaults;
+	p.pipelinedSweep = true;
+	run.check( allocationFree( "pipelined sweep", p ) );
+
+	p = defaults;
+	p.activeTolerance = 0.1f;
+	run.check( allocationFree( "active cells", p ) );
+
+	p = defaults;
+	p.reorderInterval = 2;
+	run.check( allocationFree( "reordered", p ) );
+
+	// the tiles' halos shift as the stipples move between them
+	p = defaults;
+	p.sweepTiles = 3;
+	run.check( allocationFree( "tiles", p ) );
+
+	p.closedCells = true;
+	run.check( allocationFree( "tiles, closed cells", p ) );
+
+	// the first local rebuild comes in the fourth iteration
+	p = defaults;
+	p.rebuildTolerance = 1.0f;
+	run.check( allocationFree( "local rebuild", p ) );
+
+	stippler_lib_destroy();
+	return run.finish();
+}
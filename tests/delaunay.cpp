@@ -0,0 +1,156 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// the Delaunay engine must find the same diagram as Fortune's sweep: the
+// same pairs of neighbouring sites, and from the same starting stipples
+// the same stipples a few iterations later
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "DelaunayTriangulation.h"
+#include "VoronoiDiagramGenerator.h"
+#include "testing.h"
+
+namespace {
+	typedef std::pair< int, int > SitePair;
+
+	// every edge the sweep reports must join Delaunay neighbours. the sweep
+	// clips its edges to the box, so the other way round only the Delaunay
+	// edges whose dual edge ends at two vertices inside the box must be there.
+	// an edge shorter than a tie lies between four nearly cocircular sites,
+	// where rounding picks either diagonal.
+	bool sameNeighbours( int sites ) {
+		const float size = 100.0f, tie = 1e-3f;
+
+		std::mt19937 random( 1 );
+		std::uniform_real_distribution< float > uniform( 0.0f, size );
+		std::vector< float > xValues( sites ), yValues( sites );
+		for ( int i = 0; i < sites; i++ ) {
+			xValues[i] = uniform( random );
+			yValues[i] = uniform( random );
+		}
+
+		VoronoiDiagramGenerator generator;
+		generator.generateVoronoi( &xValues[0], &yValues[0], sites, 0.0f, size, 0.0f, size );
+		const VoronoiDiagramGenerator::GraphEdges &edges = generator.getEdges();
+
+		std::vector< SitePair > swept, checked;
+		for ( size_t e = 0; e < edges.site1.size(); e++ ) {
+			if ( std::fabs( edges.x2[e] - edges.x1[e] ) + std::fabs( edges.y2[e] - edges.y1[e] ) >= tie ) {
+				checked.push_back( SitePair( std::min( edges.site1[e], edges.site2[e] ), std::max( edges.site1[e], edges.site2[e] ) ) );
+			}
+			swept.push_back( SitePair( std::min( edges.site1[e], edges.site2[e] ), std::max( edges.site1[e], edges.site2[e] ) ) );
+		}
+		std::sort( swept.begin(), swept.end() );
+
+		DelaunayTriangulation triangulation;
+		if ( !triangulation.triangulate( &xValues[0], &yValues[0], sites ) ) {
+			fprintf( stderr, "%d sites: the sites could not be triangulated\n", sites );
+			return false;
+		}
+
+		const std::vector< int > &offsets = triangulation.getOffsets(), &neighbours = triangulation.getNeighbours(), &faces = triangulation.getFaces();
+		const std::vector< float > &centresX = triangulation.getCentresX(), &centresY = triangulation.getCentresY();
+
+		std::vector< SitePair > triangulated, inside;
+		for ( int i = 0; i < sites; i++ ) {
+			int count = offsets[i + 1] - offsets[i];
+
+			for ( int k = 0; k < count; k++ ) {
+				int other = neighbours[offsets[i] + k];
+				if ( other < i ) {
+					continue;
+				}
+				triangulated.push_back( SitePair( i, other ) );
+
+				// the dual edge runs between the faces on either side of it
+				int before = faces[offsets[i] + ( k + count - 1 ) % count], after = faces[offsets[i] + k];
+				if ( before >= 0 && after >= 0 &&
+					std::fabs( centresX[after] - centresX[before] ) + std::fabs( centresY[after] - centresY[before] ) >= tie &&
+					centresX[before] > 0.0f && centresX[before] < size && centresY[before] > 0.0f && centresY[before] < size &&
+					centresX[after] > 0.0f && centresX[after] < size && centresY[after] > 0.0f && centresY[after] < size ) {
+					inside.push_back( SitePair( i, other ) );
+				}
+			}
+		}
+		std::sort( triangulated.begin(), triangulated.end() );
+
+		for ( size_t e = 0; e < checked.size(); e++ ) {
+			if ( !std::binary_search( triangulated.begin(), triangulated.end(), checked[e] ) ) {
+				fprintf( stderr, "%d sites: the sweep joined sites %d and %d, which are not Delaunay neighbours\n", sites, checked[e].first, checked[e].second );
+				return false;
+			}
+		}
+		for ( size_t e = 0; e < inside.size(); e++ ) {
+			if ( !std::binary_search( swept.begin(), swept.end(), inside[e] ) ) {
+				fprintf( stderr, "%d sites: the sweep missed the edge between sites %d and %d\n", sites, inside[e].first, inside[e].second );
+				return false;
+			}
+		}
+
+		printf( "%d sites: %u swept edges, %u Delaunay edges of which %u inside the box\n", sites,
+			(unsigned int)swept.size(), (unsigned int)triangulated.size(), (unsigned int)inside.size() );
+		return true;
+	}
+
+	// on the corpus, three iterations move the stipples of the two engines
+	// up to 0.11 px apart, since they clip the cells with differently
+	// rounded edges. the radii are left out: the sweep can measure a cell's
+	// farthest edge against a site whose cell it never meets.
+	bool sameStipples( const char *image ) {
+		StipplingParameters fortuneParameters = testParameters( image, 4000, 5 );
+		StipplingParameters delaunayParameters = testParameters( image, 4000, 5 );
+		delaunayParameters.engine = VORONOI_DELAUNAY;
+
+		std::vector<StipplePoint> expected, actual;
+		if ( !distributeStipples( fortuneParameters, 3, expected ) || !distributeStipples( delaunayParameters, 3, actual ) ) {
+			return false;
+		}
+
+		StippleDistance distance = stippleDistance( expected, actual );
+		bool close = distance.centroid <= 0.25f;
+		fprintf( close ? stdout : stderr, "%s: stipples %g px apart%s\n",
+			image, distance.centroid, close ? "" : ", over the bound" );
+		return close;
+	}
+}
+
+int main() {
+	TestRun run( "delaunay" );
+
+	run.check( sameNeighbours( 1000 ) );
+	run.check( sameNeighbours( 100000 ) );
+
+	stippler_lib_init();
+	run.check( sameStipples( "corpus/gradient.png" ) );
+	run.check( sameStipples( "corpus/phoenix.png" ) );
+	run.check( sameStipples( "corpus/vase.png" ) );
+	stippler_lib_destroy();
+
+	return run.finish();
+}
@@ -0,0 +1,68 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// the quasi-random estimator stops once the standard error of its centroid
+// falls below the tolerance. from the same starting stipples, one iteration
+// of it must land within a small bound of the sampled grid.
+
+#include <cstdio>
+#include <vector>
+
+#include "testing.h"
+
+namespace {
+	// on the corpus, one iteration at 5 subpixels and a tolerance of 0.1 px
+	// moves the centroids up to 0.3 px apart. klaymen has small dark spots
+	// in otherwise white cells, where a single sample on the spot moves the
+	// centroid, and there they end up to 1 px apart
+	bool closeCentroids( const char *image, float maxCentroidDistance ) {
+		StipplingParameters sampledParameters = testParameters( image, 4000, 5 );
+		StipplingParameters quasiRandomParameters = testParameters( image, 4000, 5 );
+		quasiRandomParameters.centroidMethod = CENTROID_QUASI_RANDOM;
+		quasiRandomParameters.centroidTolerance = 0.1f;
+
+		std::vector<StipplePoint> expected, actual;
+		if ( !distributeStipples( sampledParameters, 1, expected ) || !distributeStipples( quasiRandomParameters, 1, actual ) ) {
+			return false;
+		}
+
+		StippleDistance distance = stippleDistance( expected, actual );
+		bool close = distance.centroid <= maxCentroidDistance;
+		fprintf( close ? stdout : stderr, "%s: centroids %g px apart%s\n",
+			image, distance.centroid, close ? "" : ", over the bound" );
+		return close;
+	}
+}
+
+int main() {
+	stippler_lib_init();
+	TestRun run( "quasi_random" );
+
+	run.check( closeCentroids( "corpus/gradient.png", 0.4f ) );
+	run.check( closeCentroids( "corpus/phoenix.png", 0.4f ) );
+	run.check( closeCentroids( "corpus/vase.png", 0.4f ) );
+	run.check( closeCentroids( "corpus/klaymen.png", 1.25f ) );
+
+	stippler_lib_destroy();
+	return run.finish();
+}
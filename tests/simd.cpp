@@ -0,0 +1,75 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// the vector kernels sum the samples of a row in a different order than
+// the scalar loop, so they move the stipples slightly differently. from
+// the same starting stipples, one iteration of each must land within a
+// small bound of the other.
+
+#include <cstdio>
+#include <vector>
+
+#include "sampling.h"
+#include "testing.h"
+
+namespace {
+	// on the corpus, one iteration at 5 subpixels moves the centroids up to
+	// 0.07 px and the radii up to 0.02 px apart. on the pixel grid a cell
+	// has few samples, and one on an edge which falls the other way moves
+	// its centroid up to 0.53 px and its radius up to 0.4 px
+	bool closeCentroids( const char *image, unsigned int subpixels, float maxCentroidDistance, float maxRadiusDifference ) {
+		StipplingParameters scalarParameters = testParameters( image, 4000, subpixels );
+		scalarParameters.noSimd = true;
+		StipplingParameters vectorParameters = testParameters( image, 4000, subpixels );
+
+		std::vector<StipplePoint> expected, actual;
+		if ( !distributeStipples( scalarParameters, 1, expected ) || !distributeStipples( vectorParameters, 1, actual ) ) {
+			return false;
+		}
+
+		StippleDistance distance = stippleDistance( expected, actual );
+		bool close = distance.centroid <= maxCentroidDistance && distance.radius <= maxRadiusDifference;
+		fprintf( close ? stdout : stderr, "%s, %u subpixels: centroids %g px and radii %g px apart%s\n",
+			image, subpixels, distance.centroid, distance.radius, close ? "" : ", over the bound" );
+		return close;
+	}
+}
+
+int main() {
+	if ( selectSampleRowKernel() == NULL ) {
+		printf( "simd: no vector kernel on this processor\n" );
+		return 0;
+	}
+
+	const char *images[] = { "corpus/gradient.png", "corpus/phoenix.png", "corpus/vase.png" };
+	stippler_lib_init();
+	TestRun run( "simd" );
+
+	for ( size_t i = 0; i < sizeof( images ) / sizeof( images[0] ); i++ ) {
+		run.check( closeCentroids( images[i], 1, 0.75f, 0.5f ) );
+		run.check( closeCentroids( images[i], 5, 0.1f, 0.05f ) );
+	}
+
+	stippler_lib_destroy();
+	return run.finish();
+}
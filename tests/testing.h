@@ -0,0 +1,115 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef TESTING_H
+#define TESTING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "stippler.h"
+
+// the command line defaults, which each test changes where it needs to
+inline StipplingParameters testParameters( const char *image, unsigned int points, unsigned int subpixels ) {
+	StipplingParameters p;
+	memset( &p, 0, sizeof( p ) );
+	p.inputFile = const_cast<char *>( image );
+	p.points = points;
+	p.subpixels = subpixels;
+	p.minSubpixels = 1.0f;
+	p.maxSubpixels = 16.0f;
+	p.centroidTolerance = 0.01f;
+	p.sweepTiles = 1;
+	return p;
+}
+
+inline STIPPLER_HANDLE createTestStippler( StipplingParameters &parameters ) {
+	STIPPLER_HANDLE stippler = create_stippler( &parameters );
+	if ( stippler == NULL ) {
+		fprintf( stderr, "%s: %s\n", parameters.inputFile, stippler_getLastError() );
+	}
+	return stippler;
+}
+
+// runs a stippler for this many iterations and reads back its stipples
+inline bool distributeStipples( StipplingParameters &parameters, unsigned int iterations, std::vector<StipplePoint> &stipples ) {
+	STIPPLER_HANDLE stippler = createTestStippler( parameters );
+	if ( stippler == NULL ) {
+		return false;
+	}
+
+	for ( unsigned int iteration = 0; iteration < iterations; iteration++ ) {
+		stippler_distribute( stippler );
+	}
+
+	stipples.resize( parameters.points );
+	stippler_getStipples( stippler, &stipples[0] );
+	destroy_stippler( stippler );
+	return true;
+}
+
+// how far apart the same stipples of two runs ended up
+struct StippleDistance {
+	float centroid;		// the largest distance between two positions
+	float radius;		// the largest difference between two radii
+};
+
+inline StippleDistance stippleDistance( const std::vector<StipplePoint> &expected, const std::vector<StipplePoint> &actual ) {
+	StippleDistance distance = { 0.0f, 0.0f };
+	for ( size_t i = 0; i < expected.size() && i < actual.size(); i++ ) {
+		float dx = actual[i].x - expected[i].x, dy = actual[i].y - expected[i].y;
+		distance.centroid = std::max( distance.centroid, std::sqrt( dx * dx + dy * dy ) );
+		distance.radius = std::max( distance.radius, std::fabs( actual[i].radius - expected[i].radius ) );
+	}
+	return distance;
+}
+
+// counts the cases of a test program, which exits with a non-zero status
+// if any of them failed
+class TestRun {
+public:
+	explicit TestRun( const char *name ) : name( name ), cases( 0 ), failures( 0 ) {
+	}
+
+	void check( bool passed ) {
+		cases++;
+		if ( !passed ) {
+			failures++;
+		}
+	}
+
+	int finish() const {
+		printf( "%s: %u of %u cases failed\n", name, failures, cases );
+		return failures == 0 ? 0 : 1;
+	}
+
+private:
+	const char *name;
+	unsigned int cases;
+	unsigned int failures;
+};
+
+#endif // TESTING_H
@@ -0,0 +1,89 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// the tiled sweep stitches its tiles into the same diagram as the serial
+// sweep, so both must move the stipples identically in every iteration
+
+#include <cstring>
+#include <vector>
+
+#include "testing.h"
+
+namespace {
+	const unsigned int iterations = 10;
+
+	bool sameStipples( const char *image, unsigned int points, unsigned int tiles, bool closedCells ) {
+		StipplingParameters serialParameters = testParameters( image, points, 5 );
+		serialParameters.closedCells = closedCells;
+		StipplingParameters tiledParameters = serialParameters;
+		tiledParameters.sweepTiles = tiles;
+
+		STIPPLER_HANDLE serial = createTestStippler( serialParameters );
+		STIPPLER_HANDLE tiled = createTestStippler( tiledParameters );
+		if ( serial == NULL || tiled == NULL ) {
+			return false;
+		}
+
+		std::vector<StipplePoint> expected( points ), actual( points );
+		bool same = true;
+		for ( unsigned int iteration = 1; same && iteration <= iterations; iteration++ ) {
+			stippler_distribute( serial );
+			stippler_distribute( tiled );
+			stippler_getStipples( serial, &expected[0] );
+			stippler_getStipples( tiled, &actual[0] );
+
+			for ( unsigned int i = 0; i < points; i++ ) {
+				if ( memcmp( &expected[i].x, &actual[i].x, sizeof( float ) ) != 0 ||
+					memcmp( &expected[i].y, &actual[i].y, sizeof( float ) ) != 0 ||
+					memcmp( &expected[i].radius, &actual[i].radius, sizeof( float ) ) != 0 ) {
+					fprintf( stderr, "%s, %u stipples, %u tiles%s: iteration %u moved stipple %u to (%g, %g) r %g instead of (%g, %g) r %g\n",
+						image, points, tiles, closedCells ? ", closed cells" : "", iteration, i,
+						actual[i].x, actual[i].y, actual[i].radius, expected[i].x, expected[i].y, expected[i].radius );
+					same = false;
+					break;
+				}
+			}
+		}
+
+		destroy_stippler( tiled );
+		destroy_stippler( serial );
+		return same;
+	}
+}
+
+int main() {
+	stippler_lib_init();
+	TestRun run( "tiles" );
+
+	// phoenix has a white background, whose cells are many times the
+	// average stipple spacing across and cross the tile halos; 50 stipples
+	// over 64 tiles leave most tiles without a site of their own
+	run.check( sameStipples( "corpus/phoenix.png", 2000, 3, false ) );
+	run.check( sameStipples( "corpus/phoenix.png", 2000, 3, true ) );
+	run.check( sameStipples( "corpus/vase.png", 4000, 4, false ) );
+	run.check( sameStipples( "corpus/phoenix.png", 50, 8, false ) );
+	run.check( sameStipples( "corpus/gradient.png", 50, 8, true ) );
+
+	stippler_lib_destroy();
+	return run.finish();
+}
@@ -0,0 +1,85 @@
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// the sweep must report every edge of the diagram exactly once, including
+// the edges which never got an end point and are only clipped to the
+// bounding box once the sweep is over
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "VoronoiDiagramGenerator.h"
+#include "testing.h"
+
+namespace {
+	bool edgesOnce( const char *name, std::vector< float > xValues, std::vector< float > yValues, size_t expectedEdges ) {
+		VoronoiDiagramGenerator generator;
+		generator.generateVoronoi( &xValues[0], &yValues[0], (int)xValues.size(), 0.0f, 100.0f, 0.0f, 100.0f );
+		const VoronoiDiagramGenerator::GraphEdges &output = generator.getEdges();
+
+		std::vector< std::pair< int, int > > pairs;
+		for ( size_t e = 0; e < output.x1.size(); e++ ) {
+			int a = output.site1[e], b = output.site2[e];
+			pairs.push_back( std::make_pair( std::min( a, b ), std::max( a, b ) ) );
+		}
+		std::sort( pairs.begin(), pairs.end() );
+
+		for ( size_t i = 1; i < pairs.size(); i++ ) {
+			if ( pairs[i] == pairs[i - 1] ) {
+				fprintf( stderr, "%s: the edge between sites %d and %d was reported twice\n", name, pairs[i].first, pairs[i].second );
+				return false;
+			}
+		}
+
+		if ( expectedEdges > 0 && pairs.size() != expectedEdges ) {
+			fprintf( stderr, "%s: %u edges instead of %u\n", name, (unsigned int)pairs.size(), (unsigned int)expectedEdges );
+			return false;
+		}
+		return true;
+	}
+}
+
+int main() {
+	TestRun run( "voronoi_edges" );
+
+	// a single bisector, which neither of the two sites ever ends
+	float twoX[] = { 30.0f, 70.0f }, twoY[] = { 40.0f, 60.0f };
+	run.check( edgesOnce( "two sites", std::vector< float >( twoX, twoX + 2 ), std::vector< float >( twoY, twoY + 2 ), 1 ) );
+
+	// parallel bisectors, none of which meet
+	float rowX[] = { 20.0f, 40.0f, 60.0f, 80.0f }, rowY[] = { 50.0f, 50.0f, 50.0f, 50.0f };
+	run.check( edgesOnce( "sites in a row", std::vector< float >( rowX, rowX + 4 ), std::vector< float >( rowY, rowY + 4 ), 3 ) );
+
+	std::mt19937 random( 1 );
+	std::uniform_real_distribution< float > uniform( 0.0f, 100.0f );
+	std::vector< float > xValues( 1000 ), yValues( 1000 );
+	for ( size_t i = 0; i < xValues.size(); i++ ) {
+		xValues[i] = uniform( random );
+		yValues[i] = uniform( random );
+	}
+	run.check( edgesOnce( "random sites", xValues, yValues, 0 ) );
+
+	return run.finish();
+}
@@ -1,151 +1,256 @@
-/* The MIT License
-
-Copyright (c) 2011 Sahab Yazdani
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in
-all copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-THE SOFTWARE.
-*/
-
-#include <iostream>
-#include <string>
-#include <vector>
-#include <memory>
-#include <exception>
-
-#include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string/classification.hpp>
-#include <boost/algorithm/string/split.hpp>
-#include <boost/program_options.hpp>
-
-#include "parse_arguments.h"
-
-void showSamples() {
-	using std::cout;
-	using std::endl;
-
-	cout << "Sample usages" << endl << endl;
-	cout << "  voronoi [input] [output]" << endl;
-	cout << "\tCreates a stipple SVG image named [output] from [input] image with 4000\n\tstipple points in black and white." << endl;
-	cout << "  voronoi -s 16000 [input] [output]" << endl;
-	cout << "\tCreates a stipple SVG image named [output] from [input] image with\n\t16000 stipple points in black and white." << endl;
-	cout << "  voronoi -c [input] [output]" << endl;
-	cout << "\tCreates a stipple SVG image named [output] from [input] image with 4000\n\tstipple points in colour." << endl;
-	cout << endl;
-}
-
-std::auto_ptr<Voronoi::StipplingParameters> parseArguments( int argc, char *argv[] ) {
-	using namespace boost::program_options;
-
-	using std::auto_ptr;
-	using std::string;
-	using std::cout;
-	using std::cerr;
-	using std::endl;
-	using std::runtime_error;
-	using std::exception;
-
-	options_description requiredOpts( "Required Options" );
-	requiredOpts.add_options()
-		( "input-file,I", value< string >()->required(), "Name of input file" )
-		( "output-file,O", value< string >()->required(), "Name of output file" );
-
-	options_description helpOpts( "Help Options" );
-	helpOpts.add_options()( "help", "Help!" );
-
-	options_description basicOpts( "Basic Options" );
-	basicOpts.add_options()
-		( "stipples,s", value< int >()->default_value(4000), "Number of Stipple Points to use" )
-		( "colour-output,c", "Produce a coloured stipple drawing" );
-
-	options_description advancedOpts( "Advanced Options" );
-	advancedOpts.add_options()
-		( "threshold,t", value< float >()->default_value(0.1f, "0.1"), "How long to wait for Voronoi diagram to converge" )
-		( "no-overlap,n", "Ensure that stipple points do not overlap with each other" )
-		( "fixed-radius,f", "Fixed radius stipple points imply a significant loss of tonal properties" )
-		( "sizing-factor,z", value< float >()->default_value(1.0f, "1.0"), "The final stipple radius is multiplied by this factor" )
-		( "subpixels,p", value< int >()->default_value(5, "5"), "Controls the tile size of centroid computations." )
-		( "log,l", "Determines output verbosity" );
-
-	positional_options_description positional;
-	positional.add( "input-file", 1 );
-	positional.add( "output-file", 1 );
-
-	options_description all( "All Options" );
-	all
-		.add( requiredOpts )
-		.add( basicOpts )
-		.add( advancedOpts );
-
-	// parse the parameters
-	try {
-		variables_map help_variables;
-		store( command_line_parser( argc, argv ).options( helpOpts ).allow_unregistered().run(), help_variables );
-		notify( help_variables );
-
-		if ( help_variables.count( "help" ) > 0 ) {
-			showSamples();
-			cout << requiredOpts << endl;
-			cout << basicOpts << endl;
-			cout << advancedOpts << endl;
-
-			return auto_ptr<Voronoi::StipplingParameters>( NULL );
-		}
-
-		variables_map vm;
-		store( command_line_parser( argc, argv ).options( all ).positional( positional ).run(), vm );
-		notify( vm );
-
-		auto_ptr<Voronoi::StipplingParameters> params( new Voronoi::StipplingParameters() );
-
-		string inputFile = vm["input-file"].as<string>();
-		params->inputFile = new char[inputFile.length() + 1]; memset(params->inputFile, 0, inputFile.length() + 1);
-		inputFile.copy(params->inputFile, inputFile.length());
-		params->outputFile = vm["output-file"].as<string>();
-
-		if (vm["stipples"].as<int>() <= 0) {
-			throw runtime_error("Stipple renderings must have at least 1 stipple point.");
-		}
-		params->points = (unsigned int)vm["stipples"].as<int>();
-		if (vm["threshold"].as<float>() < 0.005f) {
-			throw runtime_error("Convergence threshold parameter must be greater than 0.005");
-		}
-		params->threshold = vm["threshold"].as<float>();
-		params->createLogs = vm.count("log") > 0;
-		params->useColour = vm.count("colour-output") > 0;
-		params->noOverlap = vm.count("no-overlap") > 0;
-		params->fixedRadius = vm.count("fixed-radius") > 0;
-		if (vm["sizing-factor"].as<float>() < 0.0f) {
-			throw runtime_error("Sizing factor parameter must be greater than 0.");
-		}
-		params->sizingFactor = vm["sizing-factor"].as<float>();
-		if (vm["subpixels"].as<int>() <= 1) {
-			throw runtime_error("Sub-pixel density parameter must be greater than or equal to 1.");
-		}
-		params->subpixels = (unsigned int)vm["subpixels"].as<int>();
-
-		return params;
-	} catch ( exception const &e ) {
-		cerr << e.what() << endl;
-		cout << endl;
-		showSamples();
-		cout << endl;
-		cout << "For more information invoke help via \"voronoi --help\"." << endl;
-
-		throw exception();
-	}
-}
+/* The MIT License
+
+Copyright (c) 2011 Sahab Yazdani
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <exception>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/program_options.hpp>
+
+#include "parse_arguments.h"
+
+void showSamples() {
+	using std::cout;
+	using std::endl;
+
+	cout << "Sample usages" << endl << endl;
+	cout << "  voronoi [input] [output]" << endl;
+	cout << "\tCreates a stipple SVG image named [output] from [input] image with 4000\n\tstipple points in black and white." << endl;
+	cout << "  voronoi -s 16000 [input] [output]" << endl;
+	cout << "\tCreates a stipple SVG image named [output] from [input] image with\n\t16000 stipple points in black and white." << endl;
+	cout << "  voronoi -c [input] [output]" << endl;
+	cout << "\tCreates a stipple SVG image named [output] from [input] image with 4000\n\tstipple points in colour." << endl;
+	cout << endl;
+}
+
+std::auto_ptr<Voronoi::StipplingParameters> parseArguments( int argc, char *argv[] ) {
+	using namespace boost::program_options;
+
+	using std::auto_ptr;
+	using std::string;
+	using std::cout;
+	using std::cerr;
+	using std::endl;
+	using std::runtime_error;
+	using std::exception;
+
+	options_description requiredOpts( "Required Options" );
+	requiredOpts.add_options()
+		( "input-file,I", value< string >()->required(), "Name of input file" )
+		( "output-file,O", value< string >()->required(), "Name of output file" );
+
+	options_description helpOpts( "Help Options" );
+	helpOpts.add_options()( "help", "Help!" );
+
+	options_description basicOpts( "Basic Options" );
+	basicOpts.add_options()
+		( "stipples,s", value< int >()->default_value(4000), "Number of Stipple Points to use" )
+		( "colour-output,c", "Produce a coloured stipple drawing" );
+
+	options_description advancedOpts( "Advanced Options" );
+	advancedOpts.add_options()
+		( "threshold,t", value< float >()->default_value(0.1f, "0.1"), "How long to wait for Voronoi diagram to converge" )
+		( "no-overlap,n", "Ensure that stipple points do not overlap with each other" )
+		( "fixed-radius,f", "Fixed radius stipple points imply a significant loss of tonal properties" )
+		( "sizing-factor,z", value< float >()->default_value(1.0f, "1.0"), "The final stipple radius is multiplied by this factor" )
+		( "subpixels,p", value< int >()->default_value(5, "5"), "Controls the tile size of centroid computations." )
+		( "cell-samples", value< int >()->default_value(0, "0"), "Picks the subpixel density of every cell to take about this many samples (0 to use the subpixel density everywhere)" )
+		( "min-subpixels", value< float >()->default_value(1.0f, "1.0"), "Lowest subpixel density picked for a cell" )
+		( "max-subpixels", value< float >()->default_value(16.0f, "16.0"), "Highest subpixel density picked for a cell" )
+		( "centroid,m", value< string >()->default_value("sampled"), "Centroid integration method (sampled, prefix-sum, scanline or quasi-random)" )
+		( "sampler", value< string >()->default_value("bilinear"), "How intensities are read between pixels (bilinear, nearest or box)" )
+		( "accumulator", value< string >()->default_value("float"), "Type the centroid moments of every cell are summed in (float or double)" )
+		( "centroid-error", value< float >()->default_value(0.1f, "0.1"), "The quasi-random centroids stop sampling once their estimated error is below this fraction of the threshold" )
+		( "engine,e", value< string >()->default_value("fortune"), "Voronoi diagram engine (fortune or delaunay)" )
+		( "beach-line", value< string >()->default_value("hashed"), "Beach line structure of the Voronoi sweep (hashed or treap)" )
+		( "event-queue", value< string >()->default_value("bucketed"), "Event queue structure of the Voronoi sweep (bucketed or heap)" )
+		( "tiles,T", value< int >()->default_value(1, "1"), "Splits the Voronoi diagram into this many tiles along each side, built in parallel" )
+		( "rebuild-tolerance,r", value< float >()->default_value(0.0f, "0.0"), "Voronoi cells are only rebuilt around stipples which moved further than this many pixels" )
+		( "active-tolerance,a", value< float >()->default_value(0.0f, "0.0"), "Cells are only integrated again around stipples which moved further than this many pixels" )
+		( "reorder,R", value< int >()->default_value(0, "0"), "Sorts the stipples along a Hilbert curve every this many iterations for memory locality (0 to disable)" )
+		( "intensity-cache,C", value< int >()->default_value(0, "0"), "Precomputes the image intensity at every subpixel in up to this many megabytes, trading memory for faster sampling (0 to disable). Only the scalar sampled and scanline centroids (--no-simd) and the quasi-random centroids read it, and it mostly pays off for the first of them" )
+		( "no-simd", "Samples the Voronoi cells with scalar code even where the processor supports vector instructions. The default vector kernels are up to 10 times faster, but add up the samples in another order, so their stipples land slightly apart from the scalar ones" )
+		( "closed-cells", "Closes the Voronoi cells along the image border and integrates them as exact polygons" )
+		( "pipeline", "Integrates every Voronoi cell as soon as the sweep completes it, while the sweep goes on (only for a single tile of open cells)" )
+		( "log,l", "Determines output verbosity" );
+
+	positional_options_description positional;
+	positional.add( "input-file", 1 );
+	positional.add( "output-file", 1 );
+
+	options_description all( "All Options" );
+	all
+		.add( requiredOpts )
+		.add( basicOpts )
+		.add( advancedOpts );
+
+	// parse the parameters
+	try {
+		variables_map help_variables;
+		store( command_line_parser( argc, argv ).options( helpOpts ).allow_unregistered().run(), help_variables );
+		notify( help_variables );
+
+		if ( help_variables.count( "help" ) > 0 ) {
+			showSamples();
+			cout << requiredOpts << endl;
+			cout << basicOpts << endl;
+			cout << advancedOpts << endl;
+
+			return auto_ptr<Voronoi::StipplingParameters>( NULL );
+		}
+
+		variables_map vm;
+		store( command_line_parser( argc, argv ).options( all ).positional( positional ).run(), vm );
+		notify( vm );
+
+		auto_ptr<Voronoi::StipplingParameters> params( new Voronoi::StipplingParameters() );
+
+		string inputFile = vm["input-file"].as<string>();
+		params->inputFile = new char[inputFile.length() + 1]; memset(params->inputFile, 0, inputFile.length() + 1);
+		inputFile.copy(params->inputFile, inputFile.length());
+		params->outputFile = vm["output-file"].as<string>();
+
+		if (vm["stipples"].as<int>() <= 0) {
+			throw runtime_error("Stipple renderings must have at least 1 stipple point.");
+		}
+		params->points = (unsigned int)vm["stipples"].as<int>();
+		if (vm["threshold"].as<float>() < 0.005f) {
+			throw runtime_error("Convergence threshold parameter must be greater than 0.005");
+		}
+		params->threshold = vm["threshold"].as<float>();
+		params->createLogs = vm.count("log") > 0;
+		params->useColour = vm.count("colour-output") > 0;
+		params->noOverlap = vm.count("no-overlap") > 0;
+		params->fixedRadius = vm.count("fixed-radius") > 0;
+		if (vm["sizing-factor"].as<float>() < 0.0f) {
+			throw runtime_error("Sizing factor parameter must be greater than 0.");
+		}
+		params->sizingFactor = vm["sizing-factor"].as<float>();
+		if (vm["subpixels"].as<int>() < 1) {
+			throw runtime_error("Sub-pixel density parameter must be greater than or equal to 1.");
+		}
+		params->subpixels = (unsigned int)vm["subpixels"].as<int>();
+		if (vm["cell-samples"].as<int>() < 0) {
+			throw runtime_error("Cell sample parameter must be greater than or equal to 0.");
+		}
+		params->cellSamples = (unsigned int)vm["cell-samples"].as<int>();
+		if (vm["min-subpixels"].as<float>() <= 0.0f) {
+			throw runtime_error("Minimum sub-pixel density parameter must be greater than 0.");
+		}
+		params->minSubpixels = vm["min-subpixels"].as<float>();
+		if (vm["max-subpixels"].as<float>() < params->minSubpixels) {
+			throw runtime_error("Maximum sub-pixel density parameter must be greater than or equal to the minimum.");
+		}
+		params->maxSubpixels = vm["max-subpixels"].as<float>();
+		if (vm["centroid"].as<string>() == "sampled") {
+			params->centroidMethod = CENTROID_SAMPLED;
+		} else if (vm["centroid"].as<string>() == "prefix-sum") {
+			params->centroidMethod = CENTROID_PREFIX_SUM;
+		} else if (vm["centroid"].as<string>() == "scanline") {
+			params->centroidMethod = CENTROID_SCANLINE;
+		} else if (vm["centroid"].as<string>() == "quasi-random") {
+			params->centroidMethod = CENTROID_QUASI_RANDOM;
+		} else {
+			throw runtime_error("Centroid method must be one of sampled, prefix-sum, scanline or quasi-random.");
+		}
+		if (vm["sampler"].as<string>() == "bilinear") {
+			params->sampler = SAMPLER_BILINEAR;
+		} else if (vm["sampler"].as<string>() == "nearest") {
+			params->sampler = SAMPLER_NEAREST;
+		} else if (vm["sampler"].as<string>() == "box") {
+			params->sampler = SAMPLER_BOX;
+		} else {
+			throw runtime_error("Sampler must be one of bilinear, nearest or box.");
+		}
+		if (vm["accumulator"].as<string>() == "float") {
+			params->accumulator = ACCUMULATOR_FLOAT;
+		} else if (vm["accumulator"].as<string>() == "double") {
+			params->accumulator = ACCUMULATOR_DOUBLE;
+		} else {
+			throw runtime_error("Accumulator must be one of float or double.");
+		}
+		if (vm["centroid-error"].as<float>() < 0.0f) {
+			throw runtime_error("Centroid error parameter must be greater than or equal to 0.");
+		}
+		params->centroidTolerance = vm["centroid-error"].as<float>() * params->threshold;
+		if (vm["engine"].as<string>() == "fortune") {
+			params->engine = VORONOI_FORTUNE;
+		} else if (vm["engine"].as<string>() == "delaunay") {
+			params->engine = VORONOI_DELAUNAY;
+		} else {
+			throw runtime_error("Voronoi engine must be one of fortune or delaunay.");
+		}
+		if (vm["beach-line"].as<string>() == "hashed") {
+			params->beachLine = SWEEP_BEACH_LINE_HASHED;
+		} else if (vm["beach-line"].as<string>() == "treap") {
+			params->beachLine = SWEEP_BEACH_LINE_TREAP;
+		} else {
+			throw runtime_error("Beach line must be one of hashed or treap.");
+		}
+		if (vm["event-queue"].as<string>() == "bucketed") {
+			params->eventQueue = SWEEP_EVENT_QUEUE_BUCKETED;
+		} else if (vm["event-queue"].as<string>() == "heap") {
+			params->eventQueue = SWEEP_EVENT_QUEUE_HEAP;
+		} else {
+			throw runtime_error("Event queue must be one of bucketed or heap.");
+		}
+		if (vm["tiles"].as<int>() < 1) {
+			throw runtime_error("Tile count parameter must be greater than or equal to 1.");
+		}
+		params->sweepTiles = (unsigned int)vm["tiles"].as<int>();
+		if (vm["rebuild-tolerance"].as<float>() < 0.0f) {
+			throw runtime_error("Rebuild tolerance parameter must be greater than or equal to 0.");
+		}
+		params->rebuildTolerance = vm["rebuild-tolerance"].as<float>();
+		if (vm["active-tolerance"].as<float>() < 0.0f) {
+			throw runtime_error("Active tolerance parameter must be greater than or equal to 0.");
+		}
+		params->activeTolerance = vm["active-tolerance"].as<float>();
+		if (vm["reorder"].as<int>() < 0) {
+			throw runtime_error("Reorder interval parameter must be greater than or equal to 0.");
+		}
+		params->reorderInterval = (unsigned int)vm["reorder"].as<int>();
+		params->closedCells = vm.count("closed-cells") > 0;
+		params->pipelinedSweep = vm.count("pipeline") > 0;
+		params->noSimd = vm.count("no-simd") > 0;
+		if (vm["intensity-cache"].as<int>() < 0) {
+			throw runtime_error("Intensity cache size must be greater than or equal to 0.");
+		}
+		params->intensityCache = (unsigned int)vm["intensity-cache"].as<int>();
+
+		return params;
+	} catch ( exception const &e ) {
+		cerr << e.what() << endl;
+		cout << endl;
+		showSamples();
+		cout << endl;
+		cout << "For more information invoke help via \"voronoi --help\"." << endl;
+
+		throw exception();
+	}
+}